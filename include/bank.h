@@ -15,6 +15,10 @@
 /// this non-inheriting version has been made, where Bank and BankC are independent classes
 /// (though they retain the same name).
 /// Of course, in this case polymorphism can no longer be exploited.
+///
+/// The class BankV<N> has the same interface as Bank<N>, but it is only a view on a
+/// bit vector stored elsewhere (e.g. a slice of a global I/O image); it must be bound
+/// to its storage with bind() before use.
 
 #define NBYTES  ((NBITS+7)/8)
 #define PREDEF  uint8_t b=((pin-1)>>3); uint8_t p=((pin-1)&0x07); if(b>=NBYTES) return 0;
@@ -40,7 +44,34 @@ class Bank
 
         uint16_t    valW(byte pos)              { return (((uint16_t)(_data[pos+1])<<8)+_data[pos]); }
         uint8_t     writeB(byte pos, byte val)  { if(pos>=NBYTES) return 0; _data[pos] = val; return 1; }
-        uint8_t     writeW(byte pos, uint16_t wval)  { if(pos>=NBYTES) return 0; _data[pos]=(wval>>8); _data[pos+1]=(wval&0xFF); return 1; }
+        uint8_t     writeW(byte pos, uint16_t wval)  { if(pos>=NBYTES) return 0; _data[pos]=(wval&0xFF); _data[pos+1]=(wval>>8); return 1; }
+
+        uint8_t     clr(void)                   { for(byte i=0; i<NBYTES; i++) _data[i]=0; return 1; }
+};
+
+template<byte NBITS>
+class BankV
+{
+    private:
+        uint8_t     *_data;
+
+    public:
+        BankV(void) : _data(nullptr) {}
+
+        void        bind(uint8_t *data) { _data = data; }
+
+        uint8_t     *val(void) { return _data; }
+        uint8_t     size(void)  { return NBYTES; }
+
+        // pin=1..N
+        uint8_t     val(byte pin)               { PREDEF; return ((_data[b]&(1<<p))!=0); }
+        uint8_t     write(byte pin, byte val)   { return (val ? set(pin) : clr(pin)); }
+        uint8_t     set(byte pin)               { PREDEF; _data[b]|=(1<<p); return 1; }
+        uint8_t     clr(byte pin)               { PREDEF; _data[b]&=(~(1<<p)); return 1; }
+
+        uint16_t    valW(byte pos)              { return (((uint16_t)(_data[pos+1])<<8)+_data[pos]); }
+        uint8_t     writeB(byte pos, byte val)  { if(pos>=NBYTES) return 0; _data[pos] = val; return 1; }
+        uint8_t     writeW(byte pos, uint16_t wval)  { if(pos>=NBYTES) return 0; _data[pos]=(wval&0xFF); _data[pos+1]=(wval>>8); return 1; }
 
         uint8_t     clr(void)                   { for(byte i=0; i<NBYTES; i++) _data[i]=0; return 1; }
 };
@@ -66,13 +97,17 @@ class BankC
         uint8_t     set(byte pin)               { PREDEF; _chg[b] |= (~_data[b] & (1<<p)); _data[b]|=(1<<p);    return 1; }
         uint8_t     clr(byte pin)               { PREDEF; _chg[b] |= (_data[b] & (1<<p));  _data[b]&=(~(1<<p)); return 1; }
 
-        //uint16_t    valW(byte pos)              { ... }
+        uint16_t    valW(byte pos)              { return (((uint16_t)(_data[pos+1])<<8)+_data[pos]); }
         //uint8_t     writeB(byte pos, byte val)  { ... }
         //uint8_t     writeW(byte pos, uint16_t wval)  { ... }
 
         uint8_t     chg(byte pin)               { PREDEF; return ((_chg[b]&(1<<p))!=0); }
         uint8_t     chgClr(byte pin)            { PREDEF; _chg[b]&=(~(1<<p)); return 1; }
 
+        // Word access to change flags (pos = byte index of the low byte)
+        uint16_t    chgW(byte pos)              { return (((uint16_t)(_chg[pos+1])<<8)+_chg[pos]); }
+        uint8_t     chgClrW(byte pos)           { if(pos+1>=NBYTES) return 0; _chg[pos]=0; _chg[pos+1]=0; return 1; }
+
         uint8_t     clr(void)                   { for(byte i=0; i<NBYTES; i++) {_data[i]=0; _chg[i]=0;} return 1; }
         uint8_t     chgClr(void)                { for(byte i=0; i<NBYTES; i++) _chg[i]=0; return 1; }
 };
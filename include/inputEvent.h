@@ -0,0 +1,71 @@
+#ifndef INPUTEVENT_H
+#define INPUTEVENT_H
+
+#include <Arduino.h>
+#include "spscRing.h"
+#include "FrameClock.h"
+
+/// Packed input event, as queued by the input processors (buttons, encoders) when running
+/// in deferred mode, and drained later by a consumer stage which invokes the user callbacks.
+///
+/// This decouples event detection from event handling: the scan never waits on a callback
+/// (e.g. one sending a message on the serial line), and a burst of events (like a fast encoder spin)
+/// only fills the queue. If the queue is full, new events are discarded and counted as overflows;
+/// the fill high-water mark is also recorded (see SPSCRing).
+///
+/// 'type' holds the source class in the high nibble and the event in the low nibble.
+/// 'delta' is an event-specific value (e.g. the number of encoder steps).
+
+struct InputEvent {
+    void*       src;        // Source object
+    uint16_t    tick;       // Time of detection (ms, truncated)
+    uint8_t     type;       // Source class | event
+    int8_t      delta;
+};
+
+enum {
+    // Source classes (high nibble)
+    IES_MASK      = 0xF0,
+    IES_BTNADV    = 0x10,   // ButtonAdv
+    IES_BTNEVT    = 0x20,   // ButtonEvt
+    IES_ENC       = 0x30,   // ManagedEnc
+    IES_BTNTBL    = 0x40,   // Button descriptor (see CtlTable)
+    IES_ENCTBL    = 0x50,   // Encoder descriptor (see CtlTable)
+
+    // Events (low nibble)
+    IEV_MASK      = 0x0F,
+    IEV_PRESS     = 0x00,
+    IEV_RELEASE   = 0x01,
+    IEV_LONG      = 0x02,
+    IEV_REPEAT    = 0x03,
+    IEV_CHANGE    = 0x04,   // Encoder count change ('delta' = count difference)
+    IEV_UP        = 0x05,   // Encoder transitions ('delta' = number of transitions)
+    IEV_DN        = 0x06,
+    IEV_FASTUP    = 0x07,
+    IEV_FASTDN    = 0x08,
+    IEV_MODE      = 0x09,   // Encoder mode change ('delta' = new mode)
+};
+
+template<uint8_t N>
+class InputEventQueue
+: public SPSCRing<InputEvent, N>
+{
+    public:
+        // Queue an event, stamped with the current frame time.
+        // Returns false if the queue was full (the event is lost).
+        bool    post(void* src, uint8_t type, int8_t delta = 0)
+        {
+            InputEvent e;
+            e.src   = src;
+            e.tick  = FrameClock::now16();
+            e.type  = type;
+            e.delta = delta;
+            return this->push(e);
+        }
+};
+
+// Event queue type used by the input processors
+constexpr uint8_t   INPUT_EVENT_QSIZE = 32;     // Must be a power of 2
+using InputEvents = InputEventQueue<INPUT_EVENT_QSIZE>;
+
+#endif // INPUTEVENT_H
@@ -0,0 +1,91 @@
+// =======================================================================
+// @file        ioImage.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Global input image, with one slice per board slot
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef IOIMAGE_H
+#define IOIMAGE_H
+
+#include <stdint.h>
+
+/// Class to handle a global I/O image made of NSLOTS slices of NBITS bits each
+///
+/// The image is a single contiguous array of machine words, with a matching
+/// "previous" image and a change mask. All slices are word-aligned (NBITS must be
+/// a multiple of the word size), so that a slice can be handed out as a plain byte
+/// vector (e.g. to be bound to a BankV); since the layout is little-endian, byte <n>
+/// of a slice always holds bits 8n..8n+7, whatever the word size.
+///
+/// update() compares the current image to the previous one in a single XOR pass
+/// over words, records the change mask and returns the set of slots that changed,
+/// so that further processing only needs to visit those.
+
+#ifdef __AVR__
+using IOword = uint8_t;         // Native word size on 8-bit targets
+#else
+using IOword = uint32_t;
+#endif
+
+template<uint8_t NSLOTS, uint8_t NBITS>
+class IOImage
+{
+    public:
+        static constexpr uint8_t  SLOTBYTES = NBITS/8;
+        static constexpr uint8_t  SLOTWORDS = SLOTBYTES/sizeof(IOword);
+        static constexpr uint16_t NWORDS    = (uint16_t)NSLOTS*SLOTWORDS;
+
+        static_assert(NSLOTS <= 16, "IOImage: max 16 slots");
+        static_assert((SLOTBYTES % sizeof(IOword)) == 0, "IOImage: slot size must be a multiple of the word size");
+
+    private:
+        IOword      _cur[NWORDS];
+        IOword      _prev[NWORDS];
+        IOword      _chg[NWORDS];
+        uint16_t    _chgSlots;
+
+    public:
+        IOImage(void) : _cur{0}, _prev{0}, _chg{0}, _chgSlots(0) {}
+
+        // Byte view of the current values/changes of slot s
+        uint8_t     *slot(uint8_t s)        { return (uint8_t *)&_cur[s*SLOTWORDS]; }
+        uint8_t     *chgSlot(uint8_t s)     { return (uint8_t *)&_chg[s*SLOTWORDS]; }
+
+        // Word access to the whole image
+        IOword      *cur(void)              { return _cur; }
+        IOword      *chg(void)              { return _chg; }
+
+        // Bit mask of the slots changed at the last update()
+        uint16_t    changes(void)           { return _chgSlots; }
+        bool        changed(uint8_t s)      { return ((_chgSlots & (1<<s)) != 0); }
+
+        // Compute the change mask against the previous image, and make the current image the previous one.
+        // Returns the bit mask of changed slots.
+        uint16_t    update(void)
+        {
+            IOword   c;
+            uint16_t w = 0;
+            _chgSlots = 0;
+            for(uint8_t s = 0; s < NSLOTS; s++) {
+                IOword any = 0;
+                for(uint8_t i = 0; i < SLOTWORDS; i++, w++) {
+                    c = _cur[w] ^ _prev[w];
+                    _chg[w]  = c;
+                    _prev[w] = _cur[w];
+                    any |= c;
+                }
+                if(any) _chgSlots |= (1<<s);
+            }
+            return _chgSlots;
+        }
+
+        // Forces all bits of the image to be reported as changed at the next update()
+        // (e.g. for initial sync)
+        void        invalidate(void)        { for(uint16_t w = 0; w < NWORDS; w++) _prev[w] = ~_cur[w]; }
+};
+
+#endif // IOIMAGE_H
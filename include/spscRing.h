@@ -0,0 +1,68 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <stdint.h>
+
+/// Lock-free single-producer / single-consumer ring buffer of N elements of type T
+/// (N must be a power of 2, max 128).
+///
+/// The producer (typically an ISR) only writes _head, the consumer (typically the main loop)
+/// only writes _tail; both indexes are free-running 8-bit counters, so that the fill level is
+/// simply (_head - _tail) and no slot is wasted.
+/// The element is always stored before the index is published (and read before the slot is released):
+/// on single-core targets like the AVR, the volatile indexes are sufficient to enforce the ordering.
+///
+/// When the buffer is full, push() discards the new element and counts an overflow.
+
+template<typename T, uint8_t N>
+class SPSCRing
+{
+    public:
+        static_assert(N != 0 && (N & (N-1)) == 0 && N <= 128, "SPSCRing: size must be a power of 2 (max 128)");
+
+    private:
+        T                   _buf[N];
+        volatile uint8_t    _head;      // Next free slot (written by the producer only)
+        volatile uint8_t    _tail;      // Next slot to read (written by the consumer only)
+        volatile uint16_t   _overflows; // Elements discarded because the buffer was full
+        uint8_t             _hiWater;   // Max fill level seen (updated by the producer)
+
+    public:
+        SPSCRing(void) : _head(0), _tail(0), _overflows(0), _hiWater(0) {}
+
+        // Producer side
+        bool        push(const T &v)
+        {
+            uint8_t h = _head;
+            uint8_t n = (uint8_t)(h - _tail);
+            if(n >= N) {
+                if(_overflows < 0xFFFF) _overflows++;
+                return false;
+            }
+            _buf[h & (N-1)] = v;
+            _head = h + 1;
+            if(n + 1 > _hiWater) _hiWater = n + 1;
+            return true;
+        }
+
+        // Consumer side
+        bool        pop(T &v)
+        {
+            uint8_t t = _tail;
+            if(t == _head) return false;
+            v = _buf[t & (N-1)];
+            _tail = t + 1;
+            return true;
+        }
+
+        bool        empty(void)         { return (_head == _tail); }
+        uint8_t     count(void)         { return (uint8_t)(_head - _tail); }
+        uint8_t     size(void)          { return N; }
+
+        // Statistics
+        uint16_t    overflows(void)     { return _overflows; }
+        uint8_t     highWater(void)     { return _hiWater; }
+        void        clearStats(void)    { _overflows = 0; _hiWater = 0; }
+};
+
+#endif // SPSCRING_H
@@ -13,7 +13,9 @@
 #include "Button.h"
 
 
-BTNcollector Button::_collect = nullptr;
+Button::BTNcollector Button::_collect = nullptr;
+InputEvents  *Button::_events = nullptr;
+Button::BTNanaReader Button::_anaRead = nullptr;
 
 Button::Button(uint8_t npin, uint8_t useHWinput, const char *name, uint8_t *mirrorvar, uint8_t mirrorbit)
 : _pin(npin)
@@ -32,6 +34,7 @@ Button::Button(uint8_t npin, uint8_t useHWinput, uint16_t tag, uint8_t *mirrorva
 void
 Button::CButton(uint8_t useHWinput, uint8_t *mirrorvar, uint8_t mirrorbit)
 {
+    setType(Button::tButton);
     valBit(0);  //lastState = LOW;
     flagChg(_flags, Button::rptEnabled, 1);  // Repeat enabled by default if present
     flagChg(_flags, Button::HWinput, useHWinput);
@@ -45,7 +48,7 @@ Button::getInput(void)
     uint8_t res = 0;
     if(isHW()) {
         if(isAna()) {
-            res = ana2dig((analogRead(_pin)+2)>>2); // Scale ADC value from 10 to 8 bits
+            res = ana2dig(readAna(_pin));
         } else {
             res = !digitalRead(_pin);
         }
@@ -23,11 +23,30 @@
 /// #define FETCH_CB if "Input Fetcher Callback" feature should be compiled
 #define FETCH_CB
 
+/// #define BTN_DEVIRT to compile buttons without virtual methods (no vtable pointer in the objects,
+/// no vtables in RAM); buttons must then be dispatched by their concrete type, which the ButtonManager
+/// does through the type tag (see Button::getType()).
+/// Calls through a plain Button* (e.g. Button::initState()) then reach the base class methods only.
+/// Each object is one pointer smaller (2 bytes on AVR), and the button vtables (kept in RAM by avr-gcc)
+/// are gone; flash size and dispatch time have not been compared with the virtual build on the target.
+/// Both builds produce the same events (host tests test_btnvirtual and test_btndevirt).
+//#define BTN_DEVIRT
+
+#ifdef BTN_DEVIRT
+#define BTN_VIRTUAL
+#define BTN_OVERRIDE
+#else
+#define BTN_VIRTUAL     virtual
+#define BTN_OVERRIDE    override
+#endif
+
 // #define MAKE_NEW to use alternative methods of allocation (defaults to standard "new")
 //#define MAKE_NEW(obj)   new obj()
 
 #include <Arduino.h>
 #include <new>
+#include "inputEvent.h"
+#include "FrameClock.h"
 
 #define flagChg(value, bitmsk, cond) ((cond) ? (value |= bitmsk) : (value &= ~bitmsk) )
 #define times10(n)  ((n<<1)+(n<<3))
@@ -49,7 +68,21 @@ derived& data(uint16_t code)                  { Button::data(code); return *this
 derived& mirror(uint8_t *mvar, uint8_t mbit)  { Button::mirror(mvar, mbit); return *this; } \
 derived& source(uint8_t *svar, uint8_t sbit)  { Button::source(svar, sbit); return *this; } \
 static derived& make(void)                    { derived* pb = new derived;    if(_collect != nullptr) _collect(pb); return *pb; } \
-static derived& make(void* p)                 { derived* pb = new(p) derived; if(_collect != nullptr) _collect(pb); return *pb; }
+static derived& make(void* p)                 { derived* pb = new(p) derived; if(_collect != nullptr) _collect(pb); return *pb; } \
+DEFINE_DEVIRT_METHODS
+
+// Without virtual methods, the base class methods calling overridable methods must be redefined
+// in each derived class, so that they bind to the derived versions.
+#ifdef BTN_DEVIRT
+#define DEFINE_DEVIRT_METHODS \
+uint8_t getInput(void)                        { return ((isHW() && isAna()) ? ana2dig(readAna(_pin)) : Button::getInput()); } \
+void initState(void)                          { check(1); } \
+void initState(uint8_t status)                { process(status); } \
+void initStateVal(uint8_t val)                { checkVal(val, 1); } \
+void initStateVec(uint8_t *bytevec)           { checkVec(bytevec, 1); }
+#else
+#define DEFINE_DEVIRT_METHODS
+#endif
 
 // Aux class for tag/Data fields
 
@@ -83,8 +116,8 @@ public:
         Low  = 0x00,    // Constant for Current status = 0
         None = 0x00,    // Constant for no trigger
         Curr = 0x01,    // Current status
-        Dn   = 0x02,    // Transitioned High->Low
-        Up   = 0x04,    // Transitioned Low->High
+        Dn   = 0x02,    // Input just became active
+        Up   = 0x04,    // Input was just released
         Rpt  = 0x08,    // Repeat activation triggered
         Long = 0x10,    // Long press activation triggered
     };
@@ -96,10 +129,23 @@ public:
         lastState   = 0x80,   // Last recorded input status
         rptEnabled  = 0x40,   // Repeat is enabled (if supported)
         Analog      = 0x20,   // Uses an analog value as input
-        HWinput     = 0x10    // Reads HW inputs directly (as opposed to receiving data)
+        HWinput     = 0x10,   // Reads HW inputs directly (as opposed to receiving data)
         //hasString   = 0x01,   // Name must be interpreted as string ptr (rather than uint_t code)
+        typeMask    = 0x0F    // Type tag (see below)
     } t_flags;
 
+    // Type tags (in the low nibble of 'flags'): identify the concrete class of a button,
+    // so that it can be dispatched without virtual calls
+    enum {
+        tButton     = 0,
+        tAdv,
+        tAna,
+        tBas,
+        tEnc,
+        tEvt,
+        nTypes
+    } t_types;
+
 
     // Bitmasks for bit nos. used for src and mirror vars
     enum {
@@ -111,6 +157,9 @@ public:
     // Define type of injected function to automatically add a new button to a given collection
     using BTNcollector = void (*)(Button*);
 
+    // Define type of injected function to read an analog input pin (value scaled to 8 bits)
+    using BTNanaReader = uint8_t (*)(uint8_t pin);
+
 protected:
 
     // If non-null, this callback is invoked when a new Button object is created with a "make" factory function,
@@ -119,6 +168,18 @@ protected:
     // its public alias "Collect()")
     static BTNcollector _collect;
 
+    // If non-null, events are queued here (deferred mode) instead of invoking the callbacks directly;
+    // callbacks are then invoked by the consumer of the queue through the dispatch() methods
+    // of the derived classes.
+    static InputEvents  *_events;
+
+    // If non-null, analog HW buttons get their value from here (e.g. a background ADC sampler)
+    // rather than from a blocking analogRead().
+    static BTNanaReader _anaRead;
+
+    static uint8_t  readAna(uint8_t pin)
+        { return (_anaRead != nullptr ? _anaRead(pin) : (uint8_t)(analogRead(pin) >> 2)); }
+
     uint8_t         _pin;
     uint8_t         _flags;
     TagData         _tag;
@@ -140,6 +201,10 @@ protected:
         flagChg(_flags, Button::Analog, v);
     }
 
+    void setType(uint8_t t) {
+        _flags = (_flags & ~Button::typeMask) | t;
+    }
+
     void valBit(uint8_t v) {
         // Record current input value
         flagChg(_flags, Button::lastState, v);
@@ -202,6 +267,10 @@ public:
 
     static void setCollector(BTNcollector cb) { _collect = cb; }
 
+    static void setEventQueue(InputEvents *q) { _events = q; }
+
+    static void setAnalogReader(BTNanaReader rd) { _anaRead = rd; }
+
     Button& Collect(void) 
         { if(_collect != nullptr) _collect(this); return *this;}
 
@@ -257,6 +326,7 @@ public:
     // ======================================
 
     uint8_t     getPin(void)            { return _pin; }
+    uint8_t     getType(void)           { return (_flags & Button::typeMask); }
     uint8_t     isHW(void)              { return ((_flags & Button::HWinput)!=0); }
     uint8_t     isAna(void)             { return ((_flags & Button::Analog) !=0); }
 
@@ -281,16 +351,16 @@ public:
     //      Button::Rpt     A repeat interval just expired
     //      Button::Long    The long press interval just expired
     // All flags except Button::curr are expected to be only set for the call right after the event occurs.
-    virtual void process(uint8_t status) { UNUSED(status); }
+    BTN_VIRTUAL void process(uint8_t status) { UNUSED(status); }
 
     // Checks the state of the button: 
     // polls status value internally and triggers events accordingly.
     // This method must be (re)defined in the specific button type classes.
-    virtual void check(bool force = false) { UNUSED(force); }
+    BTN_VIRTUAL void check(bool force = false) { UNUSED(force); }
 
     // Variant of 'check()' with input value (analog or digital, as supported)
     // passed from outside by the caller. Status flags are computed internally.
-    virtual void checkVal(uint8_t val, bool force = false) { UNUSED(val); UNUSED(force); };
+    BTN_VIRTUAL void checkVal(uint8_t val, bool force = false) { UNUSED(val); UNUSED(force); };
 
     // Variant of 'checkVal()' for digital input vectors (specific to derived class)
     // Gets its input source from the passed byte array according to pin#:
@@ -298,10 +368,10 @@ public:
     // It is responsibilty of the caller to assure that bytevec[] has a size compatible with the button's pin no.
     //
     // If the button is configured for direct HW pin reading or Analog source, a call to this method has NO EFFECT.
-    virtual void checkVec(uint8_t *bytevec, bool force = false) { UNUSED(bytevec); UNUSED(force); };
+    BTN_VIRTUAL void checkVec(uint8_t *bytevec, bool force = false) { UNUSED(bytevec); UNUSED(force); };
 
     // Supplied only by classes with analog inputs: translates the analog value to the corresponding digital state.
-    virtual bool ana2dig(uint8_t val) { return false; }
+    BTN_VIRTUAL bool ana2dig(uint8_t val) { return false; }
 
     // ======================================
     // === Initial syncing methods
@@ -31,6 +31,7 @@ ButtonAdv::ButtonAdv(
 : Button(_pin, useHWinput, name, mirrorvar, mirrorbit),
 lowerAnaThrs(lthreshold), upperAnaThrs(uthreshold)
 {
+    setType(Button::tAdv);
     CButtonAdv(rptDelay, rptRate, longPress, lthreshold, uthreshold);
 }
 
@@ -49,6 +50,7 @@ ButtonAdv::ButtonAdv(
 : Button(_pin, useHWinput, code, mirrorvar, mirrorbit),
 lowerAnaThrs(lthreshold), upperAnaThrs(uthreshold)
 {
+    setType(Button::tAdv);
     CButtonAdv(rptDelay, rptRate, longPress, lthreshold, uthreshold);
 }
 
@@ -60,7 +62,7 @@ ButtonAdv::CButtonAdv( uint16_t rptDelay, uint16_t rptRate, uint16_t longPress,
     setRepeatRate(rptRate);
     setLongPDelay(longPress);
     modeAnalog(lthreshold != uthreshold);
-    TlastChange = millis();
+    TlastChange = FrameClock::now();
     valBit(0);
 }
 
@@ -105,11 +107,29 @@ ButtonAdv::process(uint8_t sts)
     valBit((sts & Button::Curr) != 0);
     if((sts & ~Button::Curr) == 0) return; 
     
+    if(_events) {
+        if ((sts & Button::Dn) && _OnPress)   _events->post(this, IES_BTNADV | IEV_PRESS);
+        if ((sts & Button::Up) && _OnRelease) _events->post(this, IES_BTNADV | IEV_RELEASE);
+        if ((sts & Button::Long) && _OnLong)  _events->post(this, IES_BTNADV | IEV_LONG);
+        return;
+    }
     if ((sts & Button::Dn) && _OnPress)   _OnPress(this);
     if ((sts & Button::Up) && _OnRelease) _OnRelease(this);
     if ((sts & Button::Long) && _OnLong)  _OnLong(this);
 }
 
+void
+ButtonAdv::dispatch(const InputEvent &ev)
+{
+    ButtonAdv *b = (ButtonAdv *)ev.src;
+    switch(ev.type & IEV_MASK) {
+        case IEV_PRESS:     if(_OnPress)   _OnPress(b);   break;
+        case IEV_RELEASE:   if(_OnRelease) _OnRelease(b); break;
+        case IEV_LONG:      if(_OnLong)    _OnLong(b);    break;
+        default: break;
+    }
+}
+
 void
 ButtonAdv::check(bool force)
 {
@@ -140,7 +160,7 @@ ButtonAdv::checkVal(uint8_t newi, bool force)
     // bounces).
     // Quick reaction but sensitive to glitches/spikes (if sampling is very frequent)
     
-    now = millis();
+    now = FrameClock::now();
     if (now - TlastChange >= debounceTime) {
         TlastChange = 0; // We're past blanking time: rearm detection
     }
@@ -173,7 +193,7 @@ ButtonAdv::checkVal(uint8_t newi, bool force)
                 // is the startdelay passed?
                 // 'TlastPress != 0' (ie at least one repetition already happened)
                 // is only used to spare computing time, skipping the check of the whole condition.
-                if ((TlastPress != 0) || now >= TstartPress + times100(repeatDelay)) {
+                if ((TlastPress != 0) || (now - TstartPress) >= (unsigned long)times100(repeatDelay)) {
                     // is it time for a repeat keypress call?
                     if ((now - TlastPress) >= (unsigned long)times10(repeatRate)) {
                         TlastPress = now;
@@ -183,7 +203,7 @@ ButtonAdv::checkVal(uint8_t newi, bool force)
             }
             // Is long press enabled (and LP not yet triggered)?
             if (longPFlag == 0 && longPDelay > 0) {
-                if (now >= TstartPress + times100(longPDelay)) {
+                if ((now - TstartPress) >= (unsigned long)times100(longPDelay)) {
                     res |= Button::Long;
                     longPFlag = 1;      // lock further activations
                 }
@@ -37,7 +37,7 @@ public:
     // === Constructors
     // ======================================
 
-    ButtonAdv() {}     // for objects that will be completely filled in later
+    ButtonAdv() { setType(Button::tAdv); }     // for objects that will be completely filled in later
 
     ButtonAdv(  
         uint8_t     pin,
@@ -144,7 +144,7 @@ public:
     // ======================================
 
     //Retrieve the amount of milliseconds since the input vector is validated
-    uint16_t getPressTime(void) { return (uint16_t)(millis() - TstartPress); }
+    uint16_t getPressTime(void) { return (uint16_t)(FrameClock::now() - TstartPress); }
 
     // ======================================
     // === Operation methods
@@ -161,15 +161,19 @@ public:
     // All flags except Button::curr are expected to be only set for the call right after the event occurs.
     // If the button is configured for direct HW pin reading, this value is ignored and HW value fetch is performed.
     // WARNING (for HW reading only): digital inputs are considered ACTIVE (yielding HIGH) if closed to GND.
-    void    process(uint8_t status) override;
+    void    process(uint8_t status) BTN_OVERRIDE;
+
+    // Invokes the callback for an event queued by process() in deferred mode
+    // (see Button::setEventQueue()). To be called by the consumer of the event queue.
+    static void dispatch(const InputEvent &ev);
 
     // Checks the state of the button: 
     // polls status value internally and triggers events accordingly.
-    void    check(bool force = false) override;
+    void    check(bool force = false) BTN_OVERRIDE;
 
     // Variant of 'check()' with input value (analog or digital, as supported)
     // passed from outside by the caller. Status flags are computed internally.
-    void    checkVal(uint8_t value, bool force = false) override;
+    void    checkVal(uint8_t value, bool force = false) BTN_OVERRIDE;
 
     // Variant of 'checkVal()' for digital input vectors (specific to derived class)
     // Gets its input source from the passed byte array according to pin#:
@@ -177,10 +181,10 @@ public:
     // It is responsibilty of the caller to assure that bytevec[] has a size compatible with the button's pin no.
     //
     // If the button is configured for direct HW pin reading or Analog source, a call to this method has NO EFFECT.
-    void    checkVec(uint8_t *bytevec, bool force = false) override;
+    void    checkVec(uint8_t *bytevec, bool force = false) BTN_OVERRIDE;
 
     // Translates the analog value to the corresponding digital state.
-    bool    ana2dig(uint8_t val) override;
+    bool    ana2dig(uint8_t val) BTN_OVERRIDE;
 
 private:
 
@@ -25,6 +25,7 @@ ButtonAna::ButtonAna(
 : Button(npin, 0, name, mirrorvar, mirrorbit),
 lowerAnaThrs(lthreshold), upperAnaThrs(uthreshold)
 {
+    setType(Button::tAna);
     CButtonAna();
 }
 
@@ -39,6 +40,7 @@ ButtonAna::ButtonAna(
 : Button(npin, 0, code, mirrorvar, mirrorbit),
 lowerAnaThrs(lthreshold), upperAnaThrs(uthreshold)
 {
+    setType(Button::tAna);
     CButtonAna();
 }
 
@@ -46,7 +48,7 @@ void
 ButtonAna::CButtonAna(void)
 {
     hysteresis = 2;
-    TlastChange = millis();
+    TlastChange = FrameClock::now();
     valBit(0);
     if(lowerAnaThrs==upperAnaThrs) {
         // Force thresholds: they can't be the same, otherwise it isn't an Analog button
@@ -28,6 +28,7 @@ ButtonBas::ButtonBas(
 : Button(pin, useHWinput, name, mirrorvar, mirrorbit),
 lowerAnaThrs(lthreshold), upperAnaThrs(uthreshold)
 {
+    setType(Button::tBas);
     CButtonBas(lthreshold, uthreshold);
 }
 
@@ -43,6 +44,7 @@ ButtonBas::ButtonBas(
 : Button(pin, useHWinput, code, mirrorvar, mirrorbit),
 lowerAnaThrs(lthreshold), upperAnaThrs(uthreshold)
 {
+    setType(Button::tBas);
     CButtonBas(lthreshold, uthreshold);
 }
 
@@ -51,7 +53,7 @@ ButtonBas::CButtonBas(uint8_t lthreshold, uint8_t uthreshold)
 {
     debounceTime = 100;
     modeAnalog(lthreshold != uthreshold);
-    TlastChange = millis();
+    TlastChange = FrameClock::now();
     valBit(0);
 }
 
@@ -90,7 +92,7 @@ ButtonBas::checkVec(uint8_t *bytevec, bool force)
 void
 ButtonBas::checkVal(uint8_t val, bool force)
 {
-    unsigned long now = millis();
+    unsigned long now = FrameClock::now();
     uint8_t res;
 
     uint8_t curi = ((_flags & Button::lastState) ? HIGH : LOW);
@@ -30,7 +30,7 @@ public:
     // === Constructors
     // ======================================
 
-    ButtonBas() {}     // for objects that will be completely filled in later
+    ButtonBas() { setType(Button::tBas); }     // for objects that will be completely filled in later
 
     ButtonBas(  
         uint8_t     pin,
@@ -119,15 +119,15 @@ public:
     // All flags except Button::curr are expected to be only set for the call right after the event occurs.
     // If the button is configured for direct HW pin reading, this value is ignored and HW value fetch is performed.
     // WARNING (for HW reading only): digital inputs are considered ACTIVE (yielding HIGH) if closed to GND.
-    void    process(uint8_t status) override;
+    void    process(uint8_t status) BTN_OVERRIDE;
 
     // Checks the state of the button: 
     // polls status value internally and triggers events accordingly.
-    void    check(bool force = false) override;
+    void    check(bool force = false) BTN_OVERRIDE;
 
     // Variant of 'check()' with input value (analog or digital, as selected)
     // passed from outside by the caller. Status flags are computed internally.
-    void    checkVal(uint8_t val, bool force = false) override;
+    void    checkVal(uint8_t val, bool force = false) BTN_OVERRIDE;
 
     // Variant of 'checkVal()' for digital input vectors (specific to derived class)
     // Gets its input source from the passed byte array according to pin#:
@@ -135,10 +135,10 @@ public:
     // It is responsibilty of the caller to assure that bytevec[] has a size compatible with the button's pin no.
     //
     // If the button is configured for direct HW pin reading or Analog source, a call to this method has NO EFFECT.
-    void    checkVec(uint8_t *bytevec, bool force = false) override;
+    void    checkVec(uint8_t *bytevec, bool force = false) BTN_OVERRIDE;
 
     // Translates the analog value to the corresponding digital state.
-    bool ana2dig(uint8_t val) override;
+    bool ana2dig(uint8_t val) BTN_OVERRIDE;
 
 private:
 
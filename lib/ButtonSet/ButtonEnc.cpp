@@ -24,7 +24,9 @@ ButtonEnc::ButtonEnc(
 )
 : Button(index, 0, name, mirrorvar, mirrorbit), 
 TlastChange(0), TlastPress(0), debounceTime(0), longPDelay(0)
-{}
+{
+    setType(Button::tEnc);
+}
 
 
 ButtonEnc::ButtonEnc(
@@ -35,7 +37,9 @@ ButtonEnc::ButtonEnc(
 )
 : Button(index, 0, code, mirrorvar, mirrorbit),
 TlastChange(0), TlastPress(0), debounceTime(0), longPDelay(0)
-{}
+{
+    setType(Button::tEnc);
+}
 
 // Set long pressure delay (in ms; rounded to nearest 100 ms; effective range 100ms..25.5s)
 void
@@ -68,7 +72,7 @@ ButtonEnc::checkVal(uint8_t val, bool force)
     uint8_t curi = ((_flags & Button::lastState) ? HIGH : LOW);
     uint8_t newi = (val ? HIGH : LOW);
     
-    unsigned long now = millis();
+    unsigned long now = FrameClock::now();
     uint8_t res = Button::None;
 
     // Debounce strategy: Steady state
@@ -81,7 +85,7 @@ ButtonEnc::checkVal(uint8_t val, bool force)
     } else
     if (curi == HIGH && longPDelay != 0 && TlastPress != 0) {
         // Long press interval expired
-        if (now >= TlastPress + times100(longPDelay)) {
+        if ((now - TlastPress) >= (unsigned long)times100(longPDelay)) {
             TlastPress = 0;     // lock further activations
             res |= Button::Long;
         }
@@ -44,7 +44,7 @@ public:
     // The name is optional, as are the mirror variable and flag (bit# in var).
     // If the mirror var is not NULL, the button state is automatically mirrored into it.
 
-    ButtonEnc() {}     // for objects that will be completely filled in later
+    ButtonEnc() { setType(Button::tEnc); }     // for objects that will be completely filled in later
 
     ButtonEnc(  
         uint8_t     index,
@@ -111,22 +111,22 @@ public:
     //      Button::rpt     (ignored)
     //      Button::long    The long press interval just expired
     // All flags except Button::curr are expected to be only set for the call right after the event occurs.
-    void    process(uint8_t status) override;
+    void    process(uint8_t status) BTN_OVERRIDE;
 
     // Checks the state of the button (retrieving it internally)
     // and triggers events accordingly
-    void    check(bool force = false) override;
+    void    check(bool force = false) BTN_OVERRIDE;
     
     // A variant of 'check()' for single digital inputs
     // The current status is passed; status flags are computed internally,
     // then process() is called.
-    void    checkVal(uint8_t val, bool force = false) override;
+    void    checkVal(uint8_t val, bool force = false) BTN_OVERRIDE;
 
     // A variant of 'checkVal()' for digital input vectors (specific to derived class)
     // Gets its input source from the passed byte array according to pin#:
     // bytevec[0] contains values of pins 1..8 (bits 0..7), bytevec[1] contains pins 9..16 etc
     // It is responsibilty of the caller to assure that bytevec[] has a size compatible with the button's pin no.
-    void    checkVec(uint8_t *bytevec, bool force = false) override;
+    void    checkVec(uint8_t *bytevec, bool force = false) BTN_OVERRIDE;
 
 private:
 
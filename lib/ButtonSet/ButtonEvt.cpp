@@ -25,6 +25,7 @@ ButtonEvt::ButtonEvt(
 )
 : Button(npin, 0, name, mirrorvar, mirrorbit)
 {
+    setType(Button::tEvt);
     enableRepeat(rptEnabled);
 }
 
@@ -37,6 +38,7 @@ ButtonEvt::ButtonEvt(
 )
 : Button(npin, 0, code, mirrorvar, mirrorbit)
 {
+    setType(Button::tEvt);
     enableRepeat(rptEnabled);
 }
 
@@ -46,10 +48,30 @@ ButtonEvt::process(uint8_t sts)
     valBit(((sts & Button::Curr) != 0));
     if((sts & ~Button::Curr) == 0) return; 
     
+    if(_events) {
+        if ((sts & Button::Dn) && _OnPress)   _events->post(this, IES_BTNEVT | IEV_PRESS);
+        if ((sts & Button::Up) && _OnRelease) _events->post(this, IES_BTNEVT | IEV_RELEASE);
+        if ((sts & Button::Long) && _OnLong)  _events->post(this, IES_BTNEVT | IEV_LONG);
+        if ((sts & Button::Rpt) && (_flags & Button::rptEnabled) &&_OnPress) _events->post(this, IES_BTNEVT | IEV_REPEAT);
+        return;
+    }
     if ((sts & Button::Dn) && _OnPress)   _OnPress(this);
     if ((sts & Button::Up) && _OnRelease) _OnRelease(this);
     if ((sts & Button::Long) && _OnLong)  _OnLong(this);
     if ((sts & Button::Rpt) && (_flags & Button::rptEnabled) &&_OnPress) _OnPress(this);
 }
 
+void
+ButtonEvt::dispatch(const InputEvent &ev)
+{
+    ButtonEvt *b = (ButtonEvt *)ev.src;
+    switch(ev.type & IEV_MASK) {
+        case IEV_PRESS:
+        case IEV_REPEAT:    if(_OnPress)   _OnPress(b);   break;
+        case IEV_RELEASE:   if(_OnRelease) _OnRelease(b); break;
+        case IEV_LONG:      if(_OnLong)    _OnLong(b);    break;
+        default: break;
+    }
+}
+
 // end ButtonEvt.cpp
\ No newline at end of file
@@ -46,7 +46,7 @@ public:
     // The name is optional, as are the mirror variable and flag (bit# in var).
     // If the mirror var is not NULL, the button state is automatically mirrored into it.
 
-    ButtonEvt() {}     // for objects that will be completely filled in later
+    ButtonEvt() { setType(Button::tEvt); }     // for objects that will be completely filled in later
 
     ButtonEvt(  
         uint8_t     pin,
@@ -121,7 +121,11 @@ public:
     //      Button::Rpt     A repeat interval just expired
     //      Button::Long    The long press interval just expired
     // All flags except Button::curr are expected to be only set for the call right after the event occurs.
-    void    process(uint8_t status) override;
+    void    process(uint8_t status) BTN_OVERRIDE;
+
+    // Invokes the callback for an event queued by process() in deferred mode
+    // (see Button::setEventQueue()). To be called by the consumer of the event queue.
+    static void dispatch(const InputEvent &ev);
 
 private:
 
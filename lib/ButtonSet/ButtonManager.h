@@ -14,43 +14,105 @@
 
 #include <Arduino.h>
 #include "Button.h"
-
-using defaultButtonManager = ButtonManager<MAX_TOT_BUTTONS>;
+#include "CtlTable.h"
+#ifdef BTN_DEVIRT
+#include "Button_all.h"
+#endif
 
 // If the following "BM_STRAIGHT" token is defined, the manager only reports the current "static",
 // i.e. not timing-related values (current value, change flags) to buttons.
 // Button objects will then manage every timing-related aspect such as debounce, long press, repeat etc.
 // Otherwise, the manager processes these events on an input vector level and presents 
 // a complete set of flags to the button object.
-// This latter solution allows much simpler button objects (basically just callback invokers),
-// but has a less accurate implementation: timings of all buttons interfere, therefore it is
-// reasonably suitable only if a single button is "active" (i.e. changes state, waits for debounce, is on repeat...)
-// at any given time.
+// This latter solution allows much simpler button objects (basically just callback invokers).
+// Timings are computed independently for each input: every input which is "active" (i.e. changes state,
+// waits for debounce, is held down waiting for long press or on repeat) gets an entry in a small active set,
+// with its own 8-bit time stamps; inputs at rest, or held with nothing left to time, cost nothing.
+// If the active set is full, further changing inputs are simply picked up as soon as an entry is freed.
+// The latter is the default: button objects and descriptor table rows (see setTable()) rely on the
+// manager for their repeat and long press events.
+
+//#define BM_STRAIGHT
+
+// Max number of inputs timed at the same time (only used if BM_STRAIGHT is not defined)
+#ifndef BM_MAXACTIVE
+#define BM_MAXACTIVE    8
+#endif
 
-#define BM_STRAIGHT
+// Word type used for the flag planes: the native word on 8-bit targets, 64 bits elsewhere.
+// The input vector is always supplied as bytes (little-endian), whatever the word size.
+#ifdef __AVR__
+using BMword = uint8_t;
+#else
+using BMword = uint64_t;
+#endif
 
-template<uint8_t MAXSIZE>
+// MAXSIZE is the number of input bits; MAXBTNS the max number of button objects
+// (the same by default; descriptor table rows are not counted, see setTable()).
+template<uint8_t MAXSIZE, typename W = BMword, uint8_t MAXBTNS = MAXSIZE>
 class ButtonManager
 {
+    static constexpr uint8_t  WBITS    = sizeof(W)*8;
+    static constexpr uint8_t  NINBYTES = (MAXSIZE+7)/8;
+    static constexpr uint8_t  NWORDS   = (MAXSIZE+WBITS-1)/WBITS;
+    static constexpr uint8_t  NBWORDS  = (MAXBTNS+WBITS-1)/WBITS;
+    static_assert(MAXBTNS > 0, "ButtonManager: MAXBTNS must be at least 1");
+
     uint8_t         numButtons;
     uint8_t         currBut;
-    Button          *buttons[MAXSIZE] = {nullptr};
-    constexpr uint8_t NBanks = ((MAXSIZE|0x07)+1)>>3;
-
-    // Event flags for digital I/O banks
-    // Each status marker for an element is 1 byte wide, because it contains the corresponding flags
-    // for all 8 bits of the (element=)bank.
-    using _flags = struct {
-        uint8_t    LastIO;
-        uint8_t    Change;
-        uint8_t    Down;
-        uint8_t    Up;
-        uint8_t    Repeat;
-        uint8_t    LongP;
-        uint8_t    LPflag;
-    };
-    
-    _flags vec[NBanks] = {0};
+    Button          *buttons[MAXBTNS] = {nullptr};
+#ifdef BTN_DEVIRT
+    // Without virtual methods (see BTN_DEVIRT in Button.h), buttons are kept grouped by type:
+    // the buttons of type <t> are buttons[typeEnd[t-1]..typeEnd[t]-1], and each group is
+    // processed in its own loop, with direct calls.
+    uint8_t         typeEnd[Button::nTypes];
+#endif
+
+    // Event flags for digital inputs.
+    // Each flag is stored in its own plane, as a packed array of words (1 bit per input),
+    // so that all inputs of a word are processed at once.
+    W               LastIO[NWORDS];     // Last validated input values
+    W               Change[NWORDS];     // Inputs changed (in either direction)
+    W               Down[NWORDS];       // Inputs just became active
+    W               Up[NWORDS];         // Inputs just released
+    W               Repeat[NWORDS];     // Repeat event triggered
+    W               LongP[NWORDS];      // Long press event triggered
+
+    // Fetch word <w> from the input byte vector
+    static W        _load(const uint8_t *vecIO, uint8_t w);
+
+    // Inverted index from input bit to buttons, for sparse dispatch:
+    // only the buttons whose input bit has an event are processed.
+    // Buttons which fetch their own value (HW pin, source var) or are analog are not indexed:
+    // they are flagged in 'Polled' (1 bit per button index) and processed at every pass.
+    // The index is (re)built lazily at the first pass after a button was added.
+    static constexpr uint8_t NOBTN = 0xFF;
+    static_assert(MAXBTNS < NOBTN, "ButtonManager: max 254 buttons");
+    uint8_t         bitHead[MAXSIZE];   // First button (index) bound to each input bit
+    uint8_t         bitNext[MAXBTNS];   // Next button (index) bound to the same input bit
+    W               Polled[NBWORDS];
+    bool            indexValid;
+
+    // Button descriptor table (in PROGMEM, see CtlTable.h): processed along with the button objects.
+    // Rows are scanned directly at each pass (no RAM index), only rows whose input has an event are read.
+    const BtnDesc   *table;
+    uint8_t         nRows;
+
+    void _dispatchTable(uint8_t *vecIO, uint8_t doinit);
+
+    void _buildIndex(void);
+    // Compute the status for a button / for an input bit
+    template<class B>
+    uint8_t _status(B *bp, uint8_t *vecIO);
+    uint8_t _pinStatus(uint8_t pin, uint8_t *vecIO);
+#ifdef BTN_DEVIRT
+    // Let the selected buttons (1 bit per button index in 'sel') of type <t> process their status
+    template<class B>
+    void _dispatchType(uint8_t t, const W *sel, uint8_t *vecIO);
+#else
+    // Compute the status for button <i> and let it process it
+    void _dispatch(uint8_t i, uint8_t *vecIO, uint8_t doinit);
+#endif
 
     // Pointers to analog input values (externally supplied)
     uint8_t         *analogVals;
@@ -68,6 +130,44 @@ class ButtonManager
     // Helper for checkButtons()/initButtons()
     void _checkInit(uint8_t *vecIO, uint8_t doinit=0);
 
+#ifndef BM_STRAIGHT
+    // Per-input timing engine.
+    // Time stamps are 8-bit values of free-running clocks with different units (1ms, 10ms, 100ms),
+    // so that each timing is compared in the same unit as its parameter; all differences are wrap-safe.
+    enum : uint8_t {
+        PH_DEBOUNCE = 0x00,     // Input differs from its validated value, waiting for debounce ('stamp' in ms)
+        PH_HOLD     = 0x01,     // Input validated active, waiting for repeat delay / long press
+        PH_REPEAT   = 0x02,     // Input on repeat ('stamp' in 10ms units)
+        PH_MASK     = 0x03,
+        PH_LPDONE   = 0x80,     // Long press already signalled
+    };
+    using _active = struct {
+        uint8_t     bit;        // Input bit
+        uint8_t     phase;
+        uint8_t     press;      // Time of activation (100ms units)
+        uint8_t     stamp;      // Time of last event (unit depends on phase)
+        uint8_t     lpDelay;    // Timing parameters for this input (manager's own, or from the descriptor table)
+        uint8_t     rptDelay;
+        uint8_t     rptRate;
+    };
+    _active         active[BM_MAXACTIVE];
+    uint8_t         nActive;
+    W               Active[NWORDS];     // Inputs in the active set
+    W               Lost[NWORDS];       // Changed inputs left out because the active set was full
+    uint16_t        lastMs;
+    uint8_t         clk1;               // 1ms clock
+    uint8_t         clk10;              // 10ms clock
+    uint8_t         clk100;             // 100ms clock
+    uint8_t         acc10;              // ms remainders for the slower clocks
+    uint8_t         acc100;
+    uint16_t        activeOverflows;
+
+    void _clocks(void);
+    void _timeInputs(uint8_t *vecIO);
+    void _dropActive(uint8_t k);
+    void _timing(_active &e);
+#endif
+
 public:
 
     //static ButtonGroupManager *instance();
@@ -88,7 +188,16 @@ public:
     // Rounded to next 10 ms; effective range 10ms..2.55s
     void setRepeatRate(uint16_t repeat);
     // Return the pressure duration (milliseconds since the input vector was validated)
-    uint16_t getPressTime(void) {return (uint16_t)(millis() - lastChange);}
+    uint16_t getPressTime(void) {return (uint16_t)(FrameClock::now() - lastChange);}
+#ifndef BM_STRAIGHT
+    // Number of changing inputs which could not be timed immediately because the active set was full
+    uint16_t getActiveOverflows(void)   { return activeOverflows; }
+#endif
+
+    // True if the next checkButtons() may produce events even with an unchanged input vector:
+    // inputs being timed (debounce, hold, repeat), or buttons which fetch their own value.
+    // When false, checkButtons() can be skipped until the input vector changes.
+    bool busy(void);
 
     // Supply of references to externally managed Analog inputs:
     uint8_t setAnalogSource(uint8_t *aVals, uint8_t nVals);
@@ -107,7 +216,15 @@ public:
     void initButtons(uint8_t *vecIO);
 
     // Collection management:
+    // If the pin of a button already added is changed, reindex() must be called.
+    // With BTN_DEVIRT, buttons are grouped by type as they are added, therefore the index of a button
+    // (as used by get()/next()) can change when further buttons are added.
     Button *add(Button* but);
+    // Bind a button descriptor table (in PROGMEM; nullptr for none).
+    // Table rows get the same events as button objects (see CtlTable); if BM_STRAIGHT is not defined,
+    // their inputs are timed with the parameters of the row instead of the manager's own.
+    void    setTable(const BtnDesc *tbl, uint8_t n)    { table = tbl; nRows = (tbl ? n : 0); }
+    void    reindex(void)   { indexValid = false; }
     Button *get(uint8_t nBut = 0xFF);
     Button *next(uint8_t nBut = 0xFF);
 
@@ -119,4 +236,8 @@ public:
 
 #include "ButtonManager.hpp"
 
+#ifdef MAX_TOT_BUTTONS
+using defaultButtonManager = ButtonManager<MAX_TOT_BUTTONS>;
+#endif
+
 #endif
@@ -12,30 +12,46 @@
 #include <stdlib.h>
 #include "ButtonManager.h"
 
-#define FORALL_b    for(byte b=0; b<NBANKS; b++)
-#define vv          vec[b]
+#define FORALL_w    for(uint8_t w=0; w<NWORDS; w++)
+#define FORALL_bw   for(uint8_t w=0; w<NBWORDS; w++)
 
-template<uint8_t MAXSIZE>
-ButtonManager<MAXSIZE>::
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 ButtonManager(uint16_t lpDelay, uint16_t rptDelay, uint16_t rptRate)
-: lastPress(0), lastChange(0), lastRepeat(0),
-longPDelay(lpDelay), repeatDelay(rptDelay), repeatInterval(rptRate)
+: lastPress(0), lastChange(0), lastRepeat(0)
 {
     debounceTime = 20;
+    setLongPDelay(lpDelay);
+    setRepeatDelay(rptDelay);
+    setRepeatRate(rptRate);
+#ifndef BM_STRAIGHT
+    nActive = 0;
+    FORALL_w { Active[w] = Lost[w] = 0; }
+    lastMs = FrameClock::now16();
+    clk1 = clk10 = clk100 = 0;
+    acc10 = acc100 = 0;
+    activeOverflows = 0;
+#endif
 
-    FORALL_b {
-        vec[b]     = {0};
-        buttons[b] = nullptr;
+    FORALL_w {
+        LastIO[w] = Change[w] = Down[w] = Up[w] = 0;
+        Repeat[w] = LongP[w]  = 0;
     }
     numButtons  = 0;
     currBut     = 0;
+#ifdef BTN_DEVIRT
+    for(uint8_t t = 0; t < Button::nTypes; t++) typeEnd[t] = 0;
+#endif
+    indexValid  = false;
+    table       = nullptr;
+    nRows       = 0;
     analogVals  = NULL;
     nAnaVals    = 0;
 }
 
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 uint8_t
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 setAnalogSource(uint8_t *aVals, uint8_t nVals)
 {
     analogVals  = NULL;
@@ -47,9 +63,9 @@ setAnalogSource(uint8_t *aVals, uint8_t nVals)
 }
 
 // Set long pressure delay (in ms; rounded to nearest 100 ms; effective range 100ms..25.5s)
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 void
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 setLongPDelay(uint16_t delay)
 {
     if(delay > 25450) delay = 25450;
@@ -57,9 +73,9 @@ setLongPDelay(uint16_t delay)
 }
 
 // Set start delay (in ms; rounded to nearest 100 ms; effective range 100ms..25.5s)
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 void
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 setRepeatDelay(uint16_t delay)
 {
     if(delay > 25450) delay = 25450;
@@ -67,167 +83,511 @@ setRepeatDelay(uint16_t delay)
 }
 
 // Set repeat time (in ms; rounded to next 10 ms; effective range 10ms..2.55s)
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 void
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 setRepeatRate(uint16_t rate)
 {
     if(rate > 2541) rate = 2541;
     repeatInterval = (uint8_t)((rate+9)/10);       // rounded to the next 10ms
 }
 
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 Button *
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 add(Button* but)
 {
-    if (numButtons+1 < MAXSIZE) {
+    if (numButtons+1 < MAXBTNS) {
+#ifdef BTN_DEVIRT
+        // Insert at the end of the button's type group
+        uint8_t t = but->getType();
+        uint8_t pos = typeEnd[t];
+        for(uint8_t i = numButtons; i > pos; i--) buttons[i] = buttons[i-1];
+        buttons[pos] = but;
+        for(; t < Button::nTypes; t++) typeEnd[t]++;
+        numButtons++;
+#else
         numButtons++;
         buttons[numButtons-1]= but;
+#endif
+        indexValid = false;
         return but;
     }
     return NULL;
 }
 
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 Button *
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 get(uint8_t nBut) {
     return ((nBut >= numButtons) ? ((nBut == 0xFF) ? buttons[currBut] : NULL) : buttons[nBut]);
 }
 
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 Button *
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 next(uint8_t nBut) {
     if(nBut != 0xFF) currBut = nBut;
     if(currBut >= numButtons) currBut = 0;
     return buttons[currBut++];
 }
 
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+W
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_load(const uint8_t *vecIO, uint8_t w)
+{
+    if(sizeof(W) == 1) return vecIO[w];
+    W v = 0;
+    uint8_t b = w*sizeof(W);
+    for(uint8_t i = 0; i < sizeof(W) && b < NINBYTES; i++, b++) {
+        v |= ((W)vecIO[b]) << (8*i);
+    }
+    return v;
+}
+
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+void
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_buildIndex(void)
+{
+    for(uint8_t b = 0; b < MAXSIZE; b++) bitHead[b] = NOBTN;
+    FORALL_bw { Polled[w] = 0; }
+
+    // Walk backwards, so that the chains keep the order of addition
+    for(int i = numButtons-1; i >= 0; i--) {
+        Button *bp = buttons[i];
+        uint8_t pin = bp->getPin()-1;
+        bitNext[i] = NOBTN;
+        if(bp->isHW() || bp->hasSrcVar() || bp->isAna() || pin >= MAXSIZE) {
+            Polled[i/WBITS] |= ((W)1) << (i%WBITS);
+        } else {
+            bitNext[i]   = bitHead[pin];
+            bitHead[pin] = i;
+        }
+    }
+    indexValid = true;
+}
+
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+bool
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+busy(void)
+{
+    if (!indexValid) return true;
+#ifdef BM_STRAIGHT
+    if (lastChange != 0) return true;
+#else
+    if (nActive != 0) return true;
+#endif
+    FORALL_bw {
+        if (Polled[w]) return true;
+    }
+    return false;
+}
+
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 void
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 initButtons(uint8_t *vecIO)
 {
-    lastChange = millis() + debounceTime + 1;
-    FORALL_b {
-        vv.LastIO = ~(vecIO[b]);    // mark last values as opposite of current in order to trigger change flag
+    lastChange = FrameClock::now() + debounceTime + 1;
+    FORALL_w {
+        LastIO[w] = ~_load(vecIO, w);   // mark last values as opposite of current in order to trigger change flag
     }
     _checkInit(vecIO, 1);
 }
 
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 void
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 checkButtons(uint8_t *vecIO)
 {
     _checkInit(vecIO, 0);
 }
 
-template<uint8_t MAXSIZE>
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
 void
-ButtonManager<MAXSIZE>::
+ButtonManager<MAXSIZE, W, MAXBTNS>::
 _checkInit(uint8_t *vecIO, uint8_t doinit)
 {
+#ifdef BM_STRAIGHT
     unsigned long now;
-    uint8_t chg = 0;
+    bool commit = false;
 
-    now = millis();
+    now = FrameClock::now();
 
-    FORALL_b {
-        vv.Down     = 0;
-        vv.Up       = 0;
-        vv.Change   = 0;
-        vv.Repeat   = 0;
-        vv.LongP    = 0;
-    }
-    
     // Check if anything changed (shortcut for speed in most passes)
-    FORALL_b {
-        if (vecIO[b] != vv.LastIO) {
-            chg = 1; break;
+    bool chg = false;
+    FORALL_w {
+        if (_load(vecIO, w) != LastIO[w]) {
+            chg = true; break;
         }
     }
 
     if (chg) {
         if(lastChange == 0) lastChange = now;
-        if (now - lastChange >= debounceTime) {
+        if (doinit || (now - lastChange >= debounceTime)) {
             lastPress = lastChange; // this also includes debounce time
             // lastPress = now;       // this doesn't
-            lastRepeat = 0;         // Changes do reset the repeat sequence
             lastChange = 0;
-            FORALL_b {
-                uint8_t vIO = vecIO[b];
-                vv.Change   = (vIO^vv.LastIO);
-                vv.Up       = vv.Change&(vIO);
-                vv.Down     = vv.Change&(~vIO);
-                vv.LastIO   = vIO;
-                vv.LPflag  &= (~vIO);    // Reset LP flag for inputs gone low
-            }
+            commit = true;
         }
     } else {
         lastChange = 0;
     }
 
-#ifdef BM_STRAIGHT
-    // is the startdelay passed?
-    if ((repeatInterval) && (now >= lastPress + times100(repeatDelay))) {
-        if ((now - lastRepeat) >= (unsigned long)times10(repeatInterval)) {
-            // Mark active inputs for repeat
-            // This could be a single flag for all; however, marking all individual repeats
-            // could allow every single button to handle its repeat flag at its own time
-            // (requires clearing access to vecRepeat though).
-            // As a side perk, repeat is already set for active buttons only.
-            FORALL_b {
-                vv.Repeat = vecIO[b];
+    // Single pass over all flag planes, one word at a time; in most passes nothing is due,
+    // and the event planes are just cleared.
+    // Only static values (current value, changes) are reported: timings are left to the buttons.
+    FORALL_w {
+        Repeat[w] = LongP[w] = 0;
+        if (!commit) {
+            Change[w] = Down[w] = Up[w] = 0;
+            continue;
+        }
+        W vIO = _load(vecIO, w);
+        W c   = vIO ^ LastIO[w];
+        Change[w] = c;
+        Down[w]   = c & vIO;             // Became active
+        Up[w]     = c & ~vIO;            // Released
+        LastIO[w] = vIO;
+    }
+#else
+    if (doinit) {
+        // Validate all inputs at once; timings start with the next changes
+        nActive = 0;
+        FORALL_w {
+            W vIO = _load(vecIO, w);
+            W c   = vIO ^ LastIO[w];
+            Change[w] = c;
+            Down[w]   = c & vIO;
+            Up[w]     = c & ~vIO;
+            Repeat[w] = LongP[w] = 0;
+            LastIO[w] = vIO;
+            Active[w] = Lost[w] = 0;
+        }
+        lastChange = 0;
+    } else {
+        _timeInputs(vecIO);
+    }
+#endif
+
+    if (!indexValid) _buildIndex();
+
+#ifdef BTN_DEVIRT
+    // Collect the buttons to process (all of them at init: they must record their initial state),
+    // then process them type by type
+    W sel[NBWORDS];
+    FORALL_bw { sel[w] = (doinit ? (W)~0 : Polled[w]); }
+    if (!doinit) {
+        FORALL_w {
+            W ev = Change[w] | Repeat[w] | LongP[w];
+            for (uint8_t b = w*WBITS; ev != 0 && b < MAXSIZE; b++, ev >>= 1) {
+                if ((ev & 0x01) == 0) continue;
+                for (uint8_t i = bitHead[b]; i != NOBTN; i = bitNext[i]) {
+                    sel[i/WBITS] |= ((W)1) << (i%WBITS);
+                }
             }
-            lastRepeat = now;
         }
     }
+    // Init only differs from processing in the status passed, see Button::initState()
+    _dispatchType<ButtonAdv>(Button::tAdv, sel, vecIO);
+    _dispatchType<ButtonAna>(Button::tAna, sel, vecIO);
+    _dispatchType<ButtonBas>(Button::tBas, sel, vecIO);
+    _dispatchType<ButtonEnc>(Button::tEnc, sel, vecIO);
+    _dispatchType<ButtonEvt>(Button::tEvt, sel, vecIO);
+#else
+    if (doinit) {
+        // All buttons must record their initial state
+        for (uint8_t i=0; i< numButtons; i++) _dispatch(i, vecIO, 1);
+        _dispatchTable(vecIO, 1);
+        return;
+    }
 
-    if ((longPDelay) && (now >= lastPress + times100(longPDelay))) {
-        // Mark active inputs for long press
-        FORALL_b {
-            vv.LongP = vecIO[b] & (~vv.LPflag);    // Activate LP event for active inputs which haven't had LP yet
-            vv.LPflag |= vecIO[b];                 // Mask them out from next LP activations
+    // Buttons which fetch their own value
+    FORALL_bw {
+        W p = Polled[w];
+        for (uint8_t i = w*WBITS; p != 0; i++, p >>= 1) {
+            if (p & 0x01) _dispatch(i, vecIO, 0);
+        }
+    }
+
+    // Buttons bound to input bits with an event
+    FORALL_w {
+        W ev = Change[w] | Repeat[w] | LongP[w];
+        for (uint8_t b = w*WBITS; ev != 0 && b < MAXSIZE; b++, ev >>= 1) {
+            if ((ev & 0x01) == 0) continue;
+            for (uint8_t i = bitHead[b]; i != NOBTN; i = bitNext[i]) {
+                _dispatch(i, vecIO, 0);
+            }
         }
     }
 #endif
-    {
-        uint8_t sts;
-        byte pin;
-        for (int i=0; i< numButtons; i++) {
-            // Setup values (where not done implicitly) for each button
-            pin = (buttons[i]->getPin())-1;
-            if(buttons[i]->isHW()||buttons[i]->hasSrcVar()) {
-                // Button bound to HW pin or memory-(var-)based
-                // Nothing to do: the object fetches its value by itself
-                // The value for sts is dummy.
-            } else if(buttons[i]->isAna()) {
-                sts = 0;
-                if(pin < nAnaVals) {
-                    sts = buttons[i]->ana2dig(analogVals[pin]);
-                }
-            } else {
-                sts = 0;
-                byte bnk = pin>>3;
-                byte msk = (0x01 << (pin&0x07));
-                if(vecIO[bnk]       & msk) sts |= Button::Curr;
-                if(vec[bnk].Down    & msk) sts |= Button::Dn;
-                if(vec[bnk].Up      & msk) sts |= Button::Up;
-                if(vec[bnk].Repeat  & msk) sts |= Button::Rpt;
-                if(vec[bnk].LongP   & msk) sts |= Button::Long;
+
+    _dispatchTable(vecIO, doinit);
+
+    // All event planes (Change, Down, Up, Repeat, LongP) are only valid for this pass:
+    // they are rewritten at the next one.
+}
+
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+template<class B>
+uint8_t
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_status(B *bp, uint8_t *vecIO)
+{
+    uint8_t sts = 0;
+    byte pin;
+
+    // Setup values (where not done implicitly) for each button
+    pin = (bp->getPin())-1;
+    if(bp->isHW()||bp->hasSrcVar()) {
+        // Button bound to HW pin or memory-(var-)based
+        // Nothing to do: the object fetches its value by itself
+        // The value for sts is dummy.
+    } else if(bp->isAna()) {
+        if(pin < nAnaVals) {
+            sts = bp->ana2dig(analogVals[pin]);
+        }
+    } else if(pin < MAXSIZE) {
+        sts = _pinStatus(pin, vecIO);
+    }
+    return sts;
+}
+
+// Status flags for input bit <pin> (0-based, < MAXSIZE)
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+uint8_t
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_pinStatus(uint8_t pin, uint8_t *vecIO)
+{
+    uint8_t sts = 0;
+    uint8_t wrd = pin / WBITS;
+    W msk = ((W)1) << (pin % WBITS);
+    if(vecIO[pin>>3] & (0x01 << (pin&0x07))) sts |= Button::Curr;
+    if(Down[wrd]    & msk) sts |= Button::Dn;
+    if(Up[wrd]      & msk) sts |= Button::Up;
+    if(Repeat[wrd]  & msk) sts |= Button::Rpt;
+    if(LongP[wrd]   & msk) sts |= Button::Long;
+    return sts;
+}
+
+// Signal the events of the descriptor table rows whose input has an event
+// (at init: the state of all pushbuttons which are active, and of all switches)
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+void
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_dispatchTable(uint8_t *vecIO, uint8_t doinit)
+{
+    for (uint8_t r = 0; r < nRows; r++) {
+        uint8_t pin = pgm_read_byte(&table[r].pin) - 1;
+        if (pin >= MAXSIZE) continue;
+        uint8_t sts = _pinStatus(pin, vecIO);
+        if ((sts & ~Button::Curr) == 0 && !doinit) continue;
+
+        BtnDesc d;
+        CtlTable::read(&table[r], d);
+        if (doinit) {
+            if (sts & Button::Curr) {
+                CtlTable::emit(&table[r], IES_BTNTBL, IEV_PRESS);
+            } else if (d.type == CT_SWITCH) {
+                CtlTable::emit(&table[r], IES_BTNTBL, IEV_RELEASE);
             }
+            continue;
+        }
+        if (sts & Button::Dn)                   CtlTable::emit(&table[r], IES_BTNTBL, IEV_PRESS);
+        if (sts & Button::Up)                   CtlTable::emit(&table[r], IES_BTNTBL, IEV_RELEASE);
+        if ((sts & Button::Long) && d.lpDelay)  CtlTable::emit(&table[r], IES_BTNTBL, IEV_LONG);
+        if ((sts & Button::Rpt) && d.rptDelay)  CtlTable::emit(&table[r], IES_BTNTBL, IEV_REPEAT);
+    }
+}
+
+#ifdef BTN_DEVIRT
+
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+template<class B>
+void
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_dispatchType(uint8_t t, const W *sel, uint8_t *vecIO)
+{
+    for (uint8_t i = (t ? typeEnd[t-1] : 0); i < typeEnd[t]; i++) {
+        if ((sel[i/WBITS] & (((W)1) << (i%WBITS))) == 0) continue;
+        B *bp = static_cast<B *>(buttons[i]);
+        bp->process(_status(bp, vecIO));
+    }
+}
+
+#else
+
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+void
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_dispatch(uint8_t i, uint8_t *vecIO, uint8_t doinit)
+{
+    uint8_t sts = _status(buttons[i], vecIO);
+
+    // Let each button check its state and trigger its own action
+    (doinit ? buttons[i]->initState(sts) : buttons[i]->process(sts));
+}
+
+#endif
+
+#ifndef BM_STRAIGHT
+
+// Advance the time stamp clocks by the ms elapsed since the last pass
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+void
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_clocks(void)
+{
+    uint16_t ms = FrameClock::now16();
+    uint16_t d  = ms - lastMs;
+    uint32_t t;
+    lastMs = ms;
+
+    clk1   += (uint8_t)d;
+    t       = (uint32_t)d + acc10;
+    clk10  += (uint8_t)(t / 10);
+    acc10   = (uint8_t)(t % 10);
+    t       = (uint32_t)d + acc100;
+    clk100 += (uint8_t)(t / 100);
+    acc100  = (uint8_t)(t % 100);
+}
 
-            // Let each button check its state and trigger its own action
-            (doinit ? buttons[i]->initState(sts) : buttons[i]->process(sts));
+// Remove entry <k> from the active set (the last entry takes its place)
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+void
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_dropActive(uint8_t k)
+{
+    uint8_t b = active[k].bit;
+    Active[b/WBITS] &= ~(((W)1) << (b%WBITS));
+    active[k] = active[--nActive];
+}
+
+// Set the timing parameters of a new active entry: those of the descriptor table row bound
+// to the same input, if any, otherwise the manager's own
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+void
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_timing(_active &e)
+{
+    e.lpDelay  = longPDelay;
+    e.rptDelay = repeatDelay;
+    e.rptRate  = repeatInterval;
+    for (uint8_t r = 0; r < nRows; r++) {
+        if (pgm_read_byte(&table[r].pin) - 1 != e.bit) continue;
+        e.lpDelay  = pgm_read_byte(&table[r].lpDelay);
+        e.rptDelay = pgm_read_byte(&table[r].rptDelay);
+        e.rptRate  = (e.rptDelay ? pgm_read_byte(&table[r].rptRate) : 0);
+        break;
+    }
+}
+
+// Compute debounce, repeat and long press independently for each input
+template<uint8_t MAXSIZE, typename W, uint8_t MAXBTNS>
+void
+ButtonManager<MAXSIZE, W, MAXBTNS>::
+_timeInputs(uint8_t *vecIO)
+{
+    _clocks();
+
+    // Clear the event planes, and collect the inputs which started changing
+    FORALL_w {
+        Change[w] = Down[w] = Up[w] = Repeat[w] = LongP[w] = 0;
+        W d = (_load(vecIO, w) ^ LastIO[w]) & ~Active[w];
+        Lost[w] &= d;       // Inputs back to their validated value are no longer waiting
+        for (uint8_t b = w*WBITS; d != 0 && b < MAXSIZE; b++, d >>= 1) {
+            if ((d & 0x01) == 0) continue;
+            W msk = ((W)1) << (b%WBITS);
+            if (nActive >= BM_MAXACTIVE) {
+                // Retried at the next passes; counted once
+                if (!(Lost[w] & msk) && activeOverflows < 0xFFFF) activeOverflows++;
+                Lost[w] |= msk;
+                continue;
+            }
+            Lost[w] &= ~msk;
+            // The release of an input held with nothing left to time: no long press is due
+            active[nActive].bit   = b;
+            active[nActive].phase = PH_DEBOUNCE | ((LastIO[w] & msk) ? PH_LPDONE : 0);
+            active[nActive].stamp = clk1;
+            active[nActive].press = clk100;
+            _timing(active[nActive]);
+            nActive++;
+            Active[w] |= msk;
+            lastChange = FrameClock::now();
         }
     }
-    FORALL_b {
-        vv.Repeat = 0;  // repeat presses should have been handled just above.
-        vv.LongP = 0;   // same for long presses
+
+    // Time all active inputs
+    uint8_t k = 0;
+    while (k < nActive) {
+        _active &e  = active[k];
+        uint8_t wrd = e.bit / WBITS;
+        W msk       = ((W)1) << (e.bit % WBITS);
+        bool in     = ((vecIO[e.bit>>3] & (0x01 << (e.bit&0x07))) != 0);
+        bool last   = ((LastIO[wrd] & msk) != 0);
+
+        switch (e.phase & PH_MASK) {
+
+        case PH_DEBOUNCE:
+            if (in == last) {
+                // Bounce: back to the validated state
+                if (!in) { _dropActive(k); continue; }
+                e.phase = (e.phase & PH_LPDONE) | PH_HOLD;
+                break;
+            }
+            if ((uint8_t)(clk1 - e.stamp) < debounceTime) break;
+            // Validated
+            Change[wrd] |= msk;
+            LastIO[wrd] ^= msk;
+            if (!in) {
+                Up[wrd] |= msk;
+                _dropActive(k);
+                continue;
+            }
+            Down[wrd] |= msk;
+            e.phase = PH_HOLD;
+            e.press = clk100;
+            break;
+
+        case PH_HOLD:
+        case PH_REPEAT:
+            if (in != last) {
+                // Release started
+                e.phase = (e.phase & PH_LPDONE) | PH_DEBOUNCE;
+                e.stamp = clk1;
+                break;
+            }
+            if (e.lpDelay && !(e.phase & PH_LPDONE) && (uint8_t)(clk100 - e.press) >= e.lpDelay) {
+                LongP[wrd] |= msk;
+                e.phase |= PH_LPDONE;
+            }
+            if (e.rptRate) {
+                if ((e.phase & PH_MASK) == PH_HOLD) {
+                    if ((uint8_t)(clk100 - e.press) >= e.rptDelay) {
+                        Repeat[wrd] |= msk;
+                        e.phase = (e.phase & PH_LPDONE) | PH_REPEAT;
+                        e.stamp = clk10;
+                    }
+                } else if ((uint8_t)(clk10 - e.stamp) >= e.rptRate) {
+                    Repeat[wrd] |= msk;
+                    e.stamp = clk10;
+                }
+            }
+            break;
+        }
+        // Held with nothing left to time (long press done or disabled, no repeat):
+        // LastIO keeps the validated level, and the release will be picked up as a new change
+        if ((e.phase & PH_MASK) != PH_DEBOUNCE && !e.rptRate && (!e.lpDelay || (e.phase & PH_LPDONE))) {
+            _dropActive(k);
+            continue;
+        }
+        k++;
     }
 }
 
-// end ButtonManager.hpp
\ No newline at end of file
+#endif
+
+// end ButtonManager.hpp
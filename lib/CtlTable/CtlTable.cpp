@@ -0,0 +1,36 @@
+// =======================================================================
+// @file        CtlTable.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Flash-resident control descriptor tables (buttons, encoders)
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "CtlTable.h"
+
+const CTLcallback   *CtlTable::_cbs    = nullptr;
+uint8_t             CtlTable::_nCbs    = 0;
+InputEvents         *CtlTable::_events = nullptr;
+
+void
+CtlTable::emit(const void *desc, uint8_t src, uint8_t event, int8_t delta)
+{
+    if(_events) {
+        _events->post((void *)desc, src | event, delta);
+    } else {
+        _invoke(desc, event, delta);
+    }
+}
+
+void
+CtlTable::_invoke(const void *desc, uint8_t event, int8_t delta)
+{
+    // All descriptors start with the tag and the callback index
+    uint16_t tag = pgm_read_word((const uint8_t *)desc + offsetof(BtnDesc, tag));
+    uint8_t  cb  = pgm_read_byte((const uint8_t *)desc + offsetof(BtnDesc, cb));
+    if(cb < _nCbs && _cbs[cb]) _cbs[cb](tag, event, delta);
+}
+
+// end CtlTable.cpp
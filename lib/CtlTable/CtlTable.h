@@ -0,0 +1,88 @@
+// =======================================================================
+// @file        CtlTable.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Flash-resident control descriptor tables (buttons, encoders)
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef CTLTABLE_H
+#define CTLTABLE_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include "inputEvent.h"
+
+/// Controls can be described by constant descriptors stored in flash (PROGMEM), instead of
+/// being created at runtime as Button / ManagedEnc objects: the ButtonManager and EncManager
+/// iterate the tables directly (see ButtonManager::setTable(), EncManager::checkTable()), and only
+/// the state strictly required for event detection is kept in RAM.
+///
+/// The tables are built at compile time from the board definition files (see ctlTables.cpp).
+/// All descriptor types start with the same header (tag, callback index), so that events can be
+/// handled in the same way for all of them: the callback is selected by index from the table
+/// supplied with setCallbacks(), and receives the tag and the event (IEV_xxx, see inputEvent.h).
+///
+/// Like Button / ManagedEnc, events are either handled right away or queued (deferred mode,
+/// see setEventQueue()): in the latter case, the queued event refers to the descriptor itself.
+
+// Control types for button descriptors
+enum : uint8_t {
+    CT_PUSH     = 0,    // Pushbutton: events on press/release (and repeat/long press, if enabled)
+    CT_SWITCH   = 1,    // Stable position switch: its state is also reported at init
+};
+
+// Button descriptor
+struct BtnDesc {
+    uint16_t    tag;        // Control identifier passed to the callback
+    uint8_t     cb;         // Callback index
+    uint8_t     pin;        // Input pin (1..n)
+    uint8_t     type;       // CT_xxx
+    uint8_t     lpDelay;    // Long press delay (100ms units; 0 = no long press)
+    uint8_t     rptDelay;   // Repeat start delay (100ms units; 0 = no repeat)
+    uint8_t     rptRate;    // Repeat interval (10ms units)
+};
+
+// Encoder descriptor
+struct EncDesc {
+    uint16_t    tag;        // Control identifier passed to the callback
+    uint8_t     cb;         // Callback index
+    uint8_t     enc;        // Encoder number (1..n)
+    uint8_t     nModes;     // Number of modes (0 = no modes)
+};
+
+static_assert(offsetof(BtnDesc, tag) == offsetof(EncDesc, tag) && offsetof(BtnDesc, cb) == offsetof(EncDesc, cb),
+              "CtlTable: descriptors must start with the same header");
+
+// Event callback: 'delta' is the count difference for IEV_CHANGE, the number of transitions
+// for IEV_UP/IEV_DN/IEV_FASTUP/IEV_FASTDN, the new mode for IEV_MODE (0 otherwise)
+using CTLcallback = void (*)(uint16_t tag, uint8_t event, int8_t delta);
+
+class CtlTable
+{
+    private:
+        static const CTLcallback    *_cbs;
+        static uint8_t              _nCbs;
+        static InputEvents          *_events;
+
+        static void     _invoke(const void *desc, uint8_t event, int8_t delta);
+
+    public:
+        static void     setCallbacks(const CTLcallback *cbs, uint8_t n)     { _cbs = cbs; _nCbs = n; }
+        static void     setEventQueue(InputEvents *q)                       { _events = q; }
+
+        // Signal an event for a descriptor (in PROGMEM); 'src' is the source class (IES_BTNTBL, IES_ENCTBL)
+        static void     emit(const void *desc, uint8_t src, uint8_t event, int8_t delta = 0);
+
+        // Invokes the callback for an event queued in deferred mode.
+        // To be called by the consumer of the event queue.
+        static void     dispatch(const InputEvent &ev)      { _invoke(ev.src, ev.type & IEV_MASK, ev.delta); }
+
+        // Descriptor fetch from PROGMEM
+        static void     read(const BtnDesc *d, BtnDesc &v)  { memcpy_P(&v, d, sizeof(BtnDesc)); }
+        static void     read(const EncDesc *d, EncDesc &v)  { memcpy_P(&v, d, sizeof(EncDesc)); }
+};
+
+#endif // CTLTABLE_H
@@ -34,6 +34,7 @@
 #define DEBTIME_MS  2
 
 #include <Arduino.h>
+#include "FrameClock.h"
 
 template <typename T>
 class debouncer
@@ -17,7 +17,7 @@
 template <class T>
 T debouncer<T>::holder(T newi)
 {
-    unsigned long now = millis();
+    unsigned long now = FrameClock::now();
     if (newi != lastValid) {    // button state changed
         if(TlastChange == 0) {
             TlastChange = now;  // only transitions during stable states are regarded
@@ -32,7 +32,7 @@ T debouncer<T>::holder(T newi)
 template <class T>
 T debouncer<T>::delayer(T newi)
 {
-    unsigned long now = millis();
+    unsigned long now = FrameClock::now();
     if (newi != lastValid) {    // button state changed
         TlastChange = now;
     } else if (now - TlastChange >= debounceTime) {
@@ -44,7 +44,7 @@ T debouncer<T>::delayer(T newi)
 template <class T>
 T debouncer<T>::blanker(T newi)
 {
-    unsigned long now = millis();
+    unsigned long now = FrameClock::now();
     if (now - TlastChange >= debounceTime) {
         if (newi != lastValid) {    // button state changed
             lastValid = newi;
@@ -0,0 +1,75 @@
+/*
+* File     : vdebouncer.h
+*
+* Bit-parallel (vertical counter) debounce filter for input vectors
+*
+* Each input has its own saturating counter of CBITS bits; the counters are stored
+* "vertically", i.e. as CBITS bit-plane words (bit <i> of plane <k> is bit <k> of the
+* counter of input <i>), so that all inputs of a word are processed at once with a few
+* AND/XOR operations.
+*
+* At each sample, the counter of every input which differs from its validated state is
+* incremented, while the counter of every input which agrees with it is cleared;
+* an input is validated (and its counter cleared) when it has differed from the validated
+* state for 2^CBITS consecutive samples. Therefore, unlike the [debouncer] filters, a bounce
+* on one input never delays the validation of any other input.
+*
+* The filter works on sample counts, not on time: the debounce time is 2^CBITS times the
+* sampling period (e.g. 4 scan frames with CBITS = 2).
+*
+* Input and output vectors are byte vectors (little-endian, bit 0 of byte 0 = input 1),
+* whatever the word size used internally.
+*
+*/
+
+#ifndef VDEBOUNCER_H
+#define VDEBOUNCER_H
+
+#include <Arduino.h>
+
+// Word type used for the bit planes: the native word on 8-bit targets, 64 bits elsewhere.
+#ifdef __AVR__
+using VDword = uint8_t;
+#else
+using VDword = uint64_t;
+#endif
+
+template <uint8_t NIN, uint8_t CBITS = 2, typename W = VDword>
+class vdebouncer
+{
+    static constexpr uint8_t NINBYTES = (NIN+7)/8;
+    static constexpr uint8_t WBYTES   = sizeof(W);
+    static constexpr uint8_t NWORDS   = (NINBYTES+WBYTES-1)/WBYTES;
+
+    static_assert(CBITS >= 1 && CBITS <= 4, "vdebouncer: counters must be 1 to 4 bits");
+
+public:
+
+    vdebouncer()                { reset(); }
+
+    // Process a new sample of the input vector; returns the debounced vector
+    uint8_t *update(const uint8_t *value);
+
+    // Set the validated state with no filtering (e.g. at startup)
+    void reset(const uint8_t *value = nullptr);
+
+    // === Getters
+
+    // Debounced vector
+    uint8_t *status(void)       { return (uint8_t *)state; }
+    // Inputs validated (changed) at the last update, in the same format
+    uint8_t *changes(void)      { return (uint8_t *)chg; }
+
+private:
+
+    W       state[NWORDS];          // Validated inputs
+    W       chg[NWORDS];            // Inputs validated at the last update
+    W       cnt[CBITS][NWORDS];     // Counter bit planes
+
+    static W    _load(const uint8_t *value, uint8_t w);
+};
+
+// Template implementation
+#include "vdebouncer.hpp"
+
+#endif // VDEBOUNCER_H
@@ -0,0 +1,55 @@
+/*
+* File     : vdebouncer.hpp
+*
+* Bit-parallel (vertical counter) debounce filter for input vectors
+*
+*/
+
+// Bogus include to satisfy IDE syntax parser
+#ifndef VDEBOUNCER_H
+#include "vdebouncer.h"
+#endif
+
+template <uint8_t NIN, uint8_t CBITS, typename W>
+W vdebouncer<NIN, CBITS, W>::_load(const uint8_t *value, uint8_t w)
+{
+    if(WBYTES == 1) return value[w];
+    W v = 0;
+    uint8_t b = w*WBYTES;
+    for(uint8_t i = 0; i < WBYTES && b < NINBYTES; i++, b++) {
+        v |= ((W)value[b]) << (8*i);
+    }
+    return v;
+}
+
+template <uint8_t NIN, uint8_t CBITS, typename W>
+void vdebouncer<NIN, CBITS, W>::reset(const uint8_t *value)
+{
+    for(uint8_t w = 0; w < NWORDS; w++) {
+        state[w] = (value ? _load(value, w) : 0);
+        chg[w]   = 0;
+        for(uint8_t k = 0; k < CBITS; k++) cnt[k][w] = 0;
+    }
+}
+
+template <uint8_t NIN, uint8_t CBITS, typename W>
+uint8_t *vdebouncer<NIN, CBITS, W>::update(const uint8_t *value)
+{
+    for(uint8_t w = 0; w < NWORDS; w++) {
+        W delta = _load(value, w) ^ state[w];
+        // Ripple-carry increment of the inputs in 'delta'; all other counters are cleared
+        W carry = delta;
+        for(uint8_t k = 0; k < CBITS; k++) {
+            W c = cnt[k][w];
+            cnt[k][w] = (c ^ carry) & delta;
+            carry &= c;
+        }
+        // A carry out of the last plane means the counter has rolled over (and is now clear):
+        // the input has differed for 2^CBITS samples
+        chg[w]    = carry;
+        state[w] ^= carry;
+    }
+    return (uint8_t *)state;
+}
+
+// end vdebouncer.hpp
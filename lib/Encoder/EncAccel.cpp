@@ -0,0 +1,59 @@
+// =======================================================================
+// @file        EncAccel.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Velocity profiles for the encoder acceleration
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "EncAccel.h"
+
+// All profiles, one after the other; each list is terminated by intv = 0
+const EncAccel::Point EncAccel::_points[] PROGMEM = {
+    // ACC_DEFAULT
+    { THR_VERYFAST, STEP_VERYFAST },
+    { THR_FAST,     STEP_FAST },
+    { 0, 1 },
+    // ACC_NONE
+    { 0, 1 },
+    // ACC_FINE
+    { 8,    4 },
+    { 16,   2 },
+    { 0, 1 },
+    // ACC_MEDIUM
+    { 6,    10 },
+    { 12,   5 },
+    { 25,   2 },
+    { 0, 1 },
+    // ACC_COARSE
+    { 6,    20 },
+    { 12,   10 },
+    { 20,   5 },
+    { 40,   2 },
+    { 0, 1 },
+};
+
+// Position of each profile in _points[]
+const uint8_t EncAccel::_start[N_PROFILES] PROGMEM = {
+    0,      // ACC_DEFAULT
+    3,      // ACC_NONE
+    4,      // ACC_FINE
+    7,      // ACC_MEDIUM
+    11,     // ACC_COARSE
+};
+
+uint8_t
+EncAccel::mult(uint8_t profile, uint8_t intv)
+{
+    const Point *p = &_points[pgm_read_byte(&_start[profile < N_PROFILES ? profile : (uint8_t)ACC_DEFAULT])];
+    uint8_t lim;
+    while((lim = pgm_read_byte(&p->intv)) != 0) {
+        if(intv < lim) return pgm_read_byte(&p->mult);
+        p++;
+    }
+    return 1;
+}
+
+// end EncAccel.cpp
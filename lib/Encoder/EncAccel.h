@@ -0,0 +1,69 @@
+// =======================================================================
+// @file        EncAccel.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Velocity profiles for the encoder acceleration
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef ENCACCEL_H
+#define ENCACCEL_H
+
+#include <Arduino.h>
+
+/// Constants for the default acceleration profile (ACC_DEFAULT)
+/// If the period (ms) between two variations is lower than THRESHOLDn, add STEPn counts instead of just 1
+#define THR_VERYFAST    5       // very fast: <5ms
+#define STEP_VERYFAST   5       // very fast: step *5
+/// To disable second threshold, set it to the same value as first one
+#define THR_FAST        5
+//#define THR_FAST        10      // fast: <10ms
+#define STEP_FAST       5       // fast: step *5
+
+/// An acceleration profile maps the rotation speed of an encoder to the number of counts added
+/// for each step. The speed is measured as the average interval (ms) between the last ACC_HIST
+/// steps (see EncoderSetT::_accel()); the profile is a list of breakpoints in ascending order
+/// of interval: the first one whose interval is larger than the measured one gives the multiplier.
+/// Slower rotations count 1 per step.
+/// Since the interval of the first step after a pause counts as ACC_IDLE, the first ACC_HIST steps
+/// after idle (ACC_HIST-1 after a reversal) are never accelerated, however fast the spin.
+///
+/// Profiles are stored in flash; they are selected per encoder by their number (ACC_xxx), so that
+/// a board definition can assign them (see ENC_ACCEL in the board definition files).
+
+class EncAccel
+{
+    public:
+        /// Built-in profiles (max 16: the board configuration packs one per nibble)
+        enum : uint8_t {
+            ACC_DEFAULT = 0,    // THR_xxx / STEP_xxx above
+            ACC_NONE,           // No acceleration
+            ACC_FINE,           // Mild (e.g. radio frequencies, where single steps are the norm)
+            ACC_MEDIUM,         // e.g. heading, course, speed
+            ACC_COARSE,         // Strong (e.g. altitude, over a wide range)
+            N_PROFILES
+        };
+
+        static constexpr uint8_t ACC_HIST_SHIFT = 2;
+        static constexpr uint8_t ACC_HIST  = (1 << ACC_HIST_SHIFT);    // Intervals averaged
+        static constexpr uint8_t ACC_IDLE  = 0xFF;                      // Interval meaning "no recent step"
+
+        /// Profile breakpoint: multiplier for intervals below <intv> ms (intv = 0 ends the list)
+        struct Point {
+            uint8_t     intv;
+            uint8_t     mult;
+        };
+
+    private:
+        static const Point      _points[];
+        static const uint8_t    _start[N_PROFILES];
+
+    public:
+        /// Multiplier for an average step interval of <intv> ms with profile <profile>
+        /// (an unknown profile is treated as ACC_DEFAULT)
+        static uint8_t  mult(uint8_t profile, uint8_t intv);
+};
+
+#endif // ENCACCEL_H
@@ -63,6 +63,7 @@
 
 using defaultEncManager = EncManager<MAX_TOT_ENCS>;
 #include "ManagedEnc.h"
+#include "CtlTable.h"
 
 // Encoder polling callbacks:
 // - getCount()     returns the current total count of the encoder
@@ -163,6 +164,18 @@ public:
 
 #endif
 
+    // Polling function for encoder descriptor tables (in PROGMEM, see CtlTable.h), with transition flags.
+    // Row <r> describes encoder #tbl[r].enc (bit enc-1 in the flags, element enc-1 in 'counts' and 'modes');
+    // 'nEnc' is the number of elements in 'counts' and 'modes': rows for encoders beyond it are skipped.
+    // The events carry the number of counts made since the last check (accelerated steps included);
+    // if an encoder moved both ways in the period, only the net direction is signalled.
+    // 'lastModes' (one element per row, in RAM) holds the mode last signalled for each row,
+    // and is the only state required.
+    // As for checkEncs(), the caller must clear the transition flags after the check.
+    void checkTable(const EncDesc *tbl, uint8_t n,
+                    uint16_t flagsUp, uint16_t flagsDn, uint16_t flagsFastUp, uint16_t flagsFastDn,
+                    const int counts[], const uint8_t modes[], uint8_t nEnc, uint8_t lastModes[]);
+
     void        add(ManagedEnc* but);
     ManagedEnc *get(uint8_t nEnc = 0);    // nEnc = 1..254; 0 is current
     ManagedEnc *next(uint8_t nEnc = 0);   // nEnc = 1..254; 0 is next
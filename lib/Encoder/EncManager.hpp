@@ -91,6 +91,39 @@ next(uint8_t nEnc) {
     return encs[currEnc++];
 }
 
+template<uint8_t MAXSIZE>
+void
+EncManager<MAXSIZE>::
+checkTable(const EncDesc *tbl, uint8_t n,
+           uint16_t flgUp, uint16_t flgDn, uint16_t flgFastUp, uint16_t flgFastDn,
+           const int counts[], const uint8_t modes[], uint8_t nEnc, uint8_t lastModes[])
+{
+    uint16_t any = flgUp | flgDn | flgFastUp | flgFastDn;
+    for(uint8_t r = 0; r < n; r++) {
+        uint8_t  e   = pgm_read_byte(&tbl[r].enc) - 1;
+        if(e >= nEnc) continue;
+        uint16_t msk = (1U << e);
+        if(any & msk) {
+            // Counts made in the check period (at least one step, clamped to the event range)
+            int     c = (counts ? counts[e] : 1);
+            int8_t  d = (c < 0 ? (c < -127 ? 127 : -c) : (c > 127 ? 127 : (c == 0 ? 1 : c)));
+            bool    up = (flgUp & msk) || (flgFastUp & msk);
+            bool    dn = (flgDn & msk) || (flgFastDn & msk);
+            if(up && dn) {
+                // Moved both ways: the count gives the net direction (none if unknown or null)
+                up = (counts && c > 0);
+                dn = (counts && c < 0);
+            }
+            if(up) CtlTable::emit(&tbl[r], IES_ENCTBL, ((flgFastUp & msk) ? IEV_FASTUP : IEV_UP), d);
+            if(dn) CtlTable::emit(&tbl[r], IES_ENCTBL, ((flgFastDn & msk) ? IEV_FASTDN : IEV_DN), d);
+        }
+        if(modes && modes[e] != lastModes[r]) {
+            lastModes[r] = modes[e];
+            if(pgm_read_byte(&tbl[r].nModes)) CtlTable::emit(&tbl[r], IES_ENCTBL, IEV_MODE, lastModes[r]);
+        }
+    }
+}
+
 #ifdef USE_CALLBACKS
 template<uint8_t MAXSIZE>
 void
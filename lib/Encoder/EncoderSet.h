@@ -38,43 +38,65 @@
 #define EncoderM10_h
 
 #include <Arduino.h>
-#include "bitmasks.h"
+#include "FrameClock.h"
+#include "EncAccel.h"
 
-/// Max no of physical encoders managed with current implementation can be 8
-/// If you're _really_ tight on memory, reducing following parameter might help save a few bytes
-/// IMPORTANT: This class can be easily extended (or better templated) to work on a larger number
-/// of encoders (16 or even 32), by changing most of byte vars (and some constants) to uint16_t/uint32_t.
+/// The class is templated on the type of the flag vectors (EVEC, 1 bit per encoder) and on the
+/// max number of encoders (MAXENC <= bits in EVEC): the default EncoderSet (byte, 6 encoders) covers
+/// a single M10 board; wider instances (uint16_t/uint32_t, up to 16/21 encoders with a uint64_t input
+/// vector) can serve the encoders of several boards in a single update() call.
 /// However, trivial speed issues aside, on 8-bit MCUs even using 16-bit words would generate much more
 /// code with a definite penalty on code size and further on speed.
-#define MAXENC 6
+/// If you're _really_ tight on memory, reducing MAXENC might help save a few bytes.
 
 /// Type of encoder
 /// Default is full-cycle (both A/B signals make a complete cycle from one detent to another)
 /// Define following constant for half-cycle encoders
 //#define HALF_CYCLE
 
-/// Constants for Encoder acceleration
-/// If the period (ms) between two variations is lower than THRESHOLDn, add STEPn counts instead of just 1
-#define THR_VERYFAST    5       // very fast: <5ms
-#define STEP_VERYFAST   5       // very fast: step *5
-/// To disable second threshold, set it to the same value as first one
-#define THR_FAST        5
-//#define THR_FAST        10      // fast: <10ms
-#define STEP_FAST       5       // fast: step *5
+/// Quadrature transition table (see EncoderSetT::setDecoder()), indexed by the 4-bit code
+/// (prevA, prevB, A, B): +1 = quarter step up (A leads B), -1 = quarter step down, 0 = no change,
+/// QD_ILL = illegal (both lines changed: a step was missed, or contact bounce).
+/// The decoder evaluates it bit-parallel on all encoders at once: the equivalent logic is
+/// checked against the table at compile time (see below).
+constexpr int8_t QD_ILL = 2;
+constexpr int8_t QDEC_TABLE[16] = {
+//  AB:  00      01      10      11         (prev AB)
+         0,     -1,     +1,     QD_ILL,     // 00
+        +1,      0,     QD_ILL, -1,         // 01
+        -1,     QD_ILL,  0,     +1,         // 10
+        QD_ILL, +1,     -1,      0,         // 11
+};
 
 /// Constants for PUSHBUTTONS
 #define DEBOUNCE  10           // Debounce validation interval (ms)
 #define LONGPRESS 50           // Long press interval (*DEBOUNCE ms)
 
-/// Defines for future templating
-/// Must be: EVEC_BITS >= MAXENC
-typedef     byte    EVEC;                       // Must fit (1<<(MAXENC-1))
-constexpr   byte    EVEC_BITS = sizeof(EVEC)*8;
-constexpr   EVEC    ALL_MASK  = ~((EVEC)0);     // EVEC with all bits high
-
-class EncoderSet
+template<typename EVEC, uint8_t MAXENC>
+class EncoderSetT
 {
 
+public:
+
+    static constexpr byte   EVEC_BITS = sizeof(EVEC)*8;
+    static constexpr EVEC   ALL_MASK  = (EVEC)~((EVEC)0);   // EVEC with all bits high
+
+    static_assert(MAXENC <= EVEC_BITS, "EVEC must have a bit for each encoder");
+    static_assert(MAXENC*3 <= 64, "Input vectors are limited to 64 bits (3 bits per encoder)");
+
+private:
+    /// Single-bit version of the decoding logic in _quadrature(), for the check against QDEC_TABLE
+    static constexpr int8_t _qdec(byte c)
+    {
+        return ((((c>>3)^(c>>1)) & ((c>>2)^c) & 1) ? QD_ILL :
+                ((((c>>3)^(c>>1)) ^ ((c>>2)^c)) & 1) ? ((((c>>3)^c) & 1) ? -1 : +1) : 0);
+    }
+    static constexpr bool   _qdecCheck(byte c)
+    {
+        return (c >= 16) || ((_qdec(c) == QDEC_TABLE[c]) && _qdecCheck(c+1));
+    }
+    static_assert(_qdecCheck(0), "Quadrature decoding logic does not match QDEC_TABLE");
+
 public:
 
     /// Encoder transitions
@@ -122,7 +144,12 @@ public:
 
 private:
 
-    byte delta_ms;
+    /// Decoder history (per instance; kept together, since it is all accessed at every update)
+    EVEC p_encA;                // Previous values of input vectors
+    EVEC p_encB;                // (only used by quadrature decoders)
+    EVEC p_encS;
+
+    uint16_t last_ms;           // Time of last update (ms)
 
     byte nencs;                 // number of encoders managed
 
@@ -147,31 +174,85 @@ private:
     EVEC eflags_d;          // Encoder flags - down count
     EVEC eflags_inv;        // Encoder flags - inversion
 
+    /// Variables for quadrature decoders
+
+    EVEC qmode;             // Encoders in quadrature mode
+    EVEC qhalf;             // Half-cycle detents
+    EVEC qquart;            // Quarter-cycle detents (count on each transition)
+    int8_t qacc[MAXENC];    // Quarter steps accumulated since the last detent
+    byte qerr[MAXENC];      // Illegal transitions (saturated)
+
+    /// Variables for acceleration (see EncAccel)
+
+    EVEC accDir;                                // Direction of the last step (1 = up)
+    uint16_t lastStep[MAXENC];                  // Time of the last step (ms)
+    byte accHist[MAXENC][EncAccel::ACC_HIST];   // Last step intervals (ms, saturated), most recent first
+    byte accProf[MAXENC];                       // Acceleration profile (EncAccel::ACC_xxx)
+
+    /// Flag mask for encoder <n> (1..MAXENC); 0 means all encoders
+    static EVEC _mask(byte n)       { return (n==0 ? ALL_MASK : (EVEC)(((EVEC)1) << (n-1))); }
+
+    template<typename V>
+    void    _update(V vec, uint16_t now_ms);
+    void    _quadrature(EVEC pA, EVEC pB, EVEC A, EVEC B);
+    byte    _accel(byte i, uint16_t now_ms, bool up);
+
 public:
 
     /// Create a new controller (to be initialized)
-    EncoderSet(void) { init(0); };
+    EncoderSetT(void) { init(0); };
 
-    /// Create a new controller for <n> encoders (up to 8)
-    explicit EncoderSet(uint8_t n);
+    /// Create a new controller for <n> encoders (up to MAXENC)
+    explicit EncoderSetT(uint8_t n);
 
     void    init(uint8_t n);
 
     /// Invert rotation of specified encoder
     void    invert(uint8_t n, byte inverted=1);
 
+    /// Decoder types
+    /// DEC_EDGE (default) counts on the edges of channel A only, reading B for the direction
+    /// (one count per cycle, or two with HALF_CYCLE); it is the lightest, but loses counts and may
+    /// misread the direction at high spin rates or with contact bounce.
+    /// The quadrature decoders track every transition of both channels (see QDEC_TABLE), reject
+    /// illegal transitions, and count one step per full cycle (detent at A/B = 0/0), half cycle
+    /// (detents at 0/0 and 1/1) or transition.
+    static constexpr byte DEC_EDGE    = 0;
+    static constexpr byte DEC_FULL    = 1;
+    static constexpr byte DEC_HALF    = 2;
+    static constexpr byte DEC_QUARTER = 3;
+
+    /// Set decoder type of specified encoder (1..MAXENC; 0 = all)
+    void    setDecoder(byte n, byte type);
+
+    /// Number of illegal transitions detected for an encoder (quadrature decoders only; saturates at 255)
+    byte    getIllegal(byte n)          { return ((n<1) || (n>nencs) ? 0 : qerr[n-1]); }
+    void    clearIllegal(void)          { memset(qerr, 0, sizeof(qerr)); }
+
+    /// Set acceleration profile (EncAccel::ACC_xxx) of specified encoder (1..MAXENC; 0 = all)
+    void    setAccel(byte n, byte profile);
+
     /// Update when convenient: pass the time counter (in ms), the object computes when to update
     //void    update(unsigned long ms_ticks);
 
-    /// Scheduled update: no internal checks, but it is supposed be called about every 1ms
+    /// Timestamped update: <now_ms> is the time (ms) at which <vec> was sampled.
+    /// It is meant to be called about every 1ms, or at least on every change of the input vector
+    /// (calls with the same timestamp are ignored). Acceleration is computed from the intervals
+    /// between the rotation steps of each encoder, debounce from the time elapsed between calls.
     ///
     /// Encoder flags (corresponding to HW connection) assumed in the
     /// input vector passed for evaluation:
     /// Bit 0, 1, 2 = Enc1A, Enc1B, Enc1S
     /// Bit 3, 4, 5 = Enc2A, Enc2B, Enc2S
     /// Bit 6, 7, 8 = Enc3A, Enc3B, Enc3S
-    /// Argument must be at least 3 times wider than EVEC!
-    void    update(uint32_t vec);
+    /// ...
+    /// The 64-bit version is required for more than 10 encoders.
+    void    update(uint32_t vec, uint16_t now_ms)   { _update(vec, now_ms); }
+    void    update(uint64_t vec, uint16_t now_ms)   { _update(vec, now_ms); }
+
+    /// Untimed update: the input vector is assumed to be sampled in the current frame
+    void    update(uint32_t vec)        { _update(vec, FrameClock::now16()); }
+    void    update(uint64_t vec)        { _update(vec, FrameClock::now16()); }
 
     // Following functions are meant for use in more correct OOP, if key and enc vars were made private
     // Currently, for the sake of efficiency, key and enc vars are kept public despite it being bad
@@ -186,11 +267,11 @@ public:
     /// Return mask of encoders which had a transition (of the corresponding type) since last read
     /// If an enc no. != 0 is specified, the returned value is relative to that encoder only (!=0 on change)
     /// Because of inlining, no range check is performed on the encoder index
-    EVEC getEncChange(byte nenc=0)      { return trans.changed  & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getEncChangeUp(byte nenc=0)    { return trans.enUp     & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getEncChangeDn(byte nenc=0)    { return trans.enDn     & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getEncChangeQUp(byte nenc=0)   { return trans.enQUp    & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getEncChangeQDn(byte nenc=0)   { return trans.enQDn    & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
+    EVEC getEncChange(byte nenc=0)      { return trans.changed  & _mask(nenc); }
+    EVEC getEncChangeUp(byte nenc=0)    { return trans.enUp     & _mask(nenc); }
+    EVEC getEncChangeDn(byte nenc=0)    { return trans.enDn     & _mask(nenc); }
+    EVEC getEncChangeQUp(byte nenc=0)   { return trans.enQUp    & _mask(nenc); }
+    EVEC getEncChangeQDn(byte nenc=0)   { return trans.enQDn    & _mask(nenc); }
     void clearTrans(void)               { memset(&trans, 0, sizeof(t_enctstat)); }
 
     ///
@@ -199,13 +280,13 @@ public:
     /// Return mask of encoders BUTTONS which had a transition (of the corresponding type) since last read
     /// If an enc no. != 0 is specified, the returned value is relative to that encoder only (!=0 on change)
     /// Because of inlining, no range check is performed on the encoder index
-    EVEC getBtnChange(byte nenc=0)      { return btns.changed       & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getBtnPress(byte nenc=0)       { return btns.activated     & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getBtnRelease(byte nenc=0)     { return btns.deactivated   & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getBtnLongP(byte nenc=0)       { return btns.longpress     & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getBtnShortP(byte nenc=0)      { return btns.shortpress    & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getBtnToggle(byte nenc=0)      { return btns.toggled       & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
-    EVEC getBtnCurrent(byte nenc=0)     { return btns.current       & (nenc==0 ? ALL_MASK:(EVEC)wmasks[nenc-1]); }
+    EVEC getBtnChange(byte nenc=0)      { return btns.changed       & _mask(nenc); }
+    EVEC getBtnPress(byte nenc=0)       { return btns.activated     & _mask(nenc); }
+    EVEC getBtnRelease(byte nenc=0)     { return btns.deactivated   & _mask(nenc); }
+    EVEC getBtnLongP(byte nenc=0)       { return btns.longpress     & _mask(nenc); }
+    EVEC getBtnShortP(byte nenc=0)      { return btns.shortpress    & _mask(nenc); }
+    EVEC getBtnToggle(byte nenc=0)      { return btns.toggled       & _mask(nenc); }
+    EVEC getBtnCurrent(byte nenc=0)     { return btns.current       & _mask(nenc); }
     void clearBtns(void)                { memset(&btns, 0, sizeof(t_btnstat)); }
 
 
@@ -223,7 +304,7 @@ public:
     /// Return encoder BUTTONS which had a transition (of the corresponding type) since last read
     /// For change detection: if an enc no. != 0 is specified, the returned value is relative to that encoder only (!=0 on change)
     /// Because of inlining, no range check is performed on the encoder index
-    EVEC getCntChange(byte encNo=0)      __attribute__((always_inline))  { return encs.changed & (encNo==0 ? 0xFF:(EVEC)(wmasks[encNo-1])); }
+    EVEC getCntChange(byte encNo=0)      __attribute__((always_inline))  { return encs.changed & _mask(encNo); }
 
     /// Define number of modes for an encoder.
     /// 0 (default) means modes are not used
@@ -252,6 +333,11 @@ public:
     void incMode(byte nenc, byte flags);
 };
 
+#include "EncoderSet.hpp"
+
+/// Default encoder set: the encoders of a single M10 board
+using EncoderSet = EncoderSetT<byte, 6>;
+
 // Global instance (singleton use, for embedded)
 //extern EncBank EB;
 
@@ -1,6 +1,6 @@
 /********************************************************************
 *
-*    EncoderSet.cpp - A library for controlling a bank of max 3 encoders
+*    EncoderSet.hpp - A library for controlling a bank of encoders
 *    on an M10-series card
 *    Derived from EncBank class
 *
@@ -11,10 +11,10 @@
 *
 ********************************************************************/
 
-#define DEBUG 0
-
+// Bogus include to satisfy IDE syntax parser
+#ifndef EncoderM10_h
 #include "EncoderSet.h"
-#include <Arduino.h>
+#endif
 
 // Flag values
 #define F_LONGPRESS 0x01       // Long pressure for key detected
@@ -22,17 +22,25 @@
 #define F_REPEAT    0x20       // After count end, restart it
 #define F_ENCTRGR   0x80       // Encoder trigger input detected & processed
 
-// Create a new controller for <n> encoders (up to 8)
-EncoderSet::EncoderSet(uint8_t n)
+// Create a new controller for <n> encoders (up to MAXENC)
+template<typename EVEC, uint8_t MAXENC>
+EncoderSetT<EVEC, MAXENC>::
+EncoderSetT(uint8_t n)
 {
     init(n);
 }
 
+template<typename EVEC, uint8_t MAXENC>
 void
-EncoderSet::init(uint8_t n)
+EncoderSetT<EVEC, MAXENC>::
+init(uint8_t n)
 {
+    p_encA = 0;
+    p_encB = 0;
+    p_encS = 0;
     ctdbn = DEBOUNCE;
     ctlpr = LONGPRESS;
+    last_ms = FrameClock::now16();
     swvec = 0;
     swdif = 0;
     sw_up = 0;
@@ -49,6 +57,19 @@ EncoderSet::init(uint8_t n)
     eflags_inv = 0;
     //flags = 0;
 
+    qmode = 0;
+    qhalf = 0;
+    qquart = 0;
+    memset(qacc, 0, sizeof(qacc));
+    memset(qerr, 0, sizeof(qerr));
+
+    accDir = 0;
+    memset(accProf, EncAccel::ACC_DEFAULT, sizeof(accProf));
+    for(byte i = 0; i<MAXENC; i++) {
+        lastStep[i] = last_ms;
+        memset(accHist[i], EncAccel::ACC_IDLE, EncAccel::ACC_HIST);
+    }
+
     nencs = ((n>MAXENC) ? MAXENC : n);
 
     //trans.changed = 0;
@@ -70,10 +91,12 @@ EncoderSet::init(uint8_t n)
 /// Bit 3, 4, 5 = Enc2A, Enc2B, Enc2S
 /// Bit 6, 7, 8 = Enc3A, Enc3B, Enc3S
 
+template<typename EVEC, uint8_t MAXENC>
 void
-EncoderSet::invert(uint8_t n, byte inverted)
+EncoderSetT<EVEC, MAXENC>::
+invert(uint8_t n, byte inverted)
 {
-    uint8_t msk = (n==0 ? 0xFF : (0x01<<((n-1)&0x07)));
+    EVEC msk = _mask(n);
     if(inverted)
         { eflags_inv |= msk; }
     else
@@ -85,39 +108,38 @@ EncoderSet::invert(uint8_t n, byte inverted)
 //EncoderSet::update(unsigned long ms_ticks, unsigned int vec) {
 //}
 
-/// Scheduled update: no internal checks, but it is meant be called every 1ms
+/// Timestamped update: meant to be called every 1ms (or at least on each input change)
+template<typename EVEC, uint8_t MAXENC>
+template<typename V>
 void
-EncoderSet::update(uint32_t vec)
+EncoderSetT<EVEC, MAXENC>::
+_update(V vec, uint16_t now_ms)
 {
     EVEC  _encA = 0;
     EVEC  _encB = 0;
     EVEC  _encS = 0;
 
-    static EVEC     p_encA;           // Previous values of input vectors
-    //static EVEC  p_encB;           // not used
-    static EVEC     p_encS;
-    static uint32_t old_vec;
-
-    uint32_t    v;
+    V           v;
+    uint16_t    dt;
     EVEC        msk;
+    byte        delta_ms;
 
-    /// time in ms since last call (should be <255 ms!)
-    delta_ms -= (byte)(millis()&0xFF); // truncation gracefully takes care of overflow
-
-    if(delta_ms==0) {
+    /// time in ms since last call (saturated at 255 ms; wrap-safe)
+    dt = (uint16_t)(now_ms - last_ms);
+    if(dt == 0) {
         return;    /// No sense in repeated calling within less than 1ms
     }
+    delta_ms = (dt > 0xFF ? 0xFF : (byte)dt);
+    last_ms = now_ms;
 
+    // Unchanged vectors must still be processed, since debounce and long press are timed here
     msk = 0;
     v = vec;
-    if(v == old_vec) return;
-    msk = 1;
-    old_vec = v;
 //    _encS &= 0xF8;
 //    _encA &= 0xF8;
 //    _encB &= 0xFC;
-    uint16_t m1 = 0x01;
-    uint8_t  m2 = 0x01;
+    V    m1 = 0x01;
+    EVEC m2 = 0x01;
     for(byte e=0; e<nencs; e++) {
         if(v & m1) { _encA |= m2; }
         m1 <<= 1;
@@ -138,15 +160,19 @@ EncoderSet::update(uint32_t vec)
     //enAvec = _encA;   // No particular use, but make it available
     //enBvec = _encB;   // No particular use, but make it available
 
+    eflags_u = 0;
+    eflags_d = 0;
+
+    // Edge decoders (see DEC_EDGE):
     // This particular encoder always returns Ch.A/B to 0/0 at rest positions,
     // so the status must be detected on a state change of one of the channels.
     // Channel A is chosen for the trigger transition: the (steady) status of channel B gives the direction
-    if(_encA != p_encA) {           // Encoder Ch.A (trigger) input detected
+    if((_encA ^ p_encA) & ~qmode) {  // Encoder Ch.A (trigger) input detected
 
         // Full-cycle encoders:
         // filter out bits in _encA which have risen (or fallen, if inverted):
         //v = _encA & (_encA ^ p_encA);
-        v = (_encA ^ eflags_inv) & (_encA ^ p_encA);
+        v = (_encA ^ eflags_inv) & (_encA ^ p_encA) & ~qmode;
         // determine direction
         eflags_u = v & (~_encB);      // Up: A=0->1,  B=0
         eflags_d = v & _encB;         // Dn: A=0->1,  B=1
@@ -155,23 +181,32 @@ EncoderSet::update(uint32_t vec)
         // Half-cycle encoders:
         // also filter out bits in _encA which have fallen (or risen, if inverted):
         //v = (~_encA) & (_encA ^ p_encA);
-        v = (~(_encA ^ eflags_inv) & (_encA ^ p_encA));
+        v = (~(_encA ^ eflags_inv) & (_encA ^ p_encA) & ~qmode);
         // determine direction (reverse code than before)
         eflags_d |= v & (~_encB);      // Dn: A=0->1,  B=0
         eflags_u |= v & _encB;         // Up: A=0->1,  B=1
 #endif
+    }
 
-        p_encA = _encA;
-        //p_encB = _encB;   // (currently unused)
+    // Quadrature decoders (see DEC_FULL etc.)
+    if(((_encA ^ p_encA) | (_encB ^ p_encB)) & qmode) {
+        _quadrature(p_encA, p_encB, _encA, _encB);
+    }
 
-        // for each bit <i> set in eflags_u, add 1 (or larger step, if delta-T < threshold) to encs.ecount[i];
-        // for each bit <i> set in eflags_d, sub 1 (or larger step, if delta-T < threshold) to encs.ecount[i];
-        // v = 1;
-        v = ((delta_ms < THR_VERYFAST) ? STEP_VERYFAST : ((delta_ms < THR_FAST) ? STEP_FAST : 1));
+    p_encA = _encA;
+    p_encB = _encB;
 
+    if(eflags_u | eflags_d) {
+        // for each bit <i> set in eflags_u, add 1 (or larger step, according to the rotation speed) to encs.ecount[i];
+        // for each bit <i> set in eflags_d, sub 1 (or larger step, according to the rotation speed) to encs.ecount[i];
+        // the speed is measured separately for each encoder (see _accel()).
+        EVEC fast = 0;
         msk = 0x01;
         for(byte i = 0; i<nencs; i++, msk<<=1) {
-            encs.ecount[i]  += ((eflags_u&msk) ? v : ((eflags_d&msk) ? -v : 0));
+            if(((eflags_u|eflags_d) & msk) == 0) continue;
+            byte step = _accel(i, now_ms, (eflags_u & msk) != 0);
+            encs.ecount[i] += ((eflags_u&msk) ? step : -step);
+            if(step > 1) fast |= msk;
         }
         encs.changed |= (eflags_d|eflags_u);
 
@@ -179,12 +214,9 @@ EncoderSet::update(uint32_t vec)
         trans.enDn |= eflags_d;
         trans.changed |= (eflags_d|eflags_u);
 
-        // TODO Check & test
-        if(v > 1) {
-            trans.enQUp |= eflags_u;
-            trans.enQDn |= eflags_d;
-            // trans.changed is set by enUp/enDn
-        }
+        // trans.changed is set by enUp/enDn
+        trans.enQUp |= (eflags_u & fast);
+        trans.enQDn |= (eflags_d & fast);
     }
 
     ///
@@ -234,16 +266,16 @@ EncoderSet::update(uint32_t vec)
         /// manage mode change
         msk = 0x01;
         for(byte i = 0; i<nencs; i++, msk<<=1) {
-            if(encs.emode[i] & ~((byte)EncoderSet::MODE_LONGPRESS)) {
+            if(encs.emode[i] & ~((byte)MODE_LONGPRESS)) {
                 /// handle modechange + Push&Hold-On
                 if(sw_up & msk) {
-                    if((encs.emode[i] & EncoderSet::MODE_LONGPRESS) == 0) {
+                    if((encs.emode[i] & MODE_LONGPRESS) == 0) {
                         incMode(i, 0x00);
                     }
                 }
                 /// handle Push&Hold-Off
                 if(sw_dn & msk) {
-                    if(encs.emode[i] == EncoderSet::MODE_PUSHHOLD) {
+                    if(encs.emode[i] == MODE_PUSHHOLD) {
                         setMode(i, 1);
                     }
                 }
@@ -283,43 +315,160 @@ EncoderSet::update(uint32_t vec)
     }
 }
 
+/// Quadrature decoding, for the encoders in quadrature mode (bit-parallel on all encoders).
+/// The transitions are classified as in QDEC_TABLE (see the static_assert in EncoderSet.h);
+/// valid steps are accumulated per encoder, and a count is issued when the encoder reaches
+/// a detent position.
+template<typename EVEC, uint8_t MAXENC>
+void
+EncoderSetT<EVEC, MAXENC>::
+_quadrature(EVEC pA, EVEC pB, EVEC A, EVEC B)
+{
+    EVEC chA  = (A ^ pA) & qmode;
+    EVEC chB  = (B ^ pB) & qmode;
+    EVEC ill  = chA & chB;              // Both lines changed: a step was missed (or bounce)
+    EVEC stp  = chA ^ chB;              // Valid quarter step
+    EVEC up   = stp & ~(pA ^ B);        // A leads B
+    EVEC d00  = ~(A | B);               // Detent positions
+    EVEC d11  = A & B;
+    EVEC act  = ill | stp;
+    EVEC msk  = 0x01;
+
+    for(byte i = 0; i<nencs && act; i++, msk<<=1) {
+        if((act & msk) == 0) continue;
+        act &= ~msk;
+        if(ill & msk) {
+            // Position unknown: drop the partial steps
+            if(qerr[i] < 0xFF) qerr[i]++;
+            qacc[i] = 0;
+            continue;
+        }
+        qacc[i] += ((up & msk) ? 1 : -1);
+
+        int8_t cnt = 0;
+        if(qquart & msk) {
+            cnt = qacc[i];
+        } else if(qhalf & msk) {
+            if((d00|d11) & msk) cnt = (qacc[i] > 0 ? 1 : (qacc[i] < 0 ? -1 : 0));
+        } else {
+            // Full cycle: at least half a cycle must have been made in the same direction
+            if(d00 & msk) cnt = (qacc[i] >= 2 ? 1 : (qacc[i] <= -2 ? -1 : 0));
+        }
+        if(cnt != 0 || (d00 & msk)) qacc[i] = 0;
+        if(cnt == 0) continue;
+        if((cnt > 0) != ((eflags_inv & msk) != 0)) {
+            eflags_u |= msk;
+        } else {
+            eflags_d |= msk;
+        }
+    }
+}
+
+/// Set the decoder type for an encoder (0 = all)
+template<typename EVEC, uint8_t MAXENC>
+void
+EncoderSetT<EVEC, MAXENC>::
+setDecoder(byte n, byte type)
+{
+    EVEC msk = _mask(n);
+    qmode &= ~msk;
+    qhalf &= ~msk;
+    qquart &= ~msk;
+    if(type == DEC_FULL || type == DEC_HALF || type == DEC_QUARTER) qmode  |= msk;
+    if(type == DEC_HALF)    qhalf  |= msk;
+    if(type == DEC_QUARTER) qquart |= msk;
+    for(byte i = 0; i<MAXENC; i++) {
+        if(msk & (((EVEC)1) << i)) qacc[i] = 0;
+    }
+}
+
+/// Count multiplier for a step of encoder <i> (0-based) in direction <up>, taken at <now_ms>.
+/// The rotation speed is the average of the last ACC_HIST step intervals; the history restarts
+/// (as if the encoder had been idle) when the direction is reversed, so that turning back is never
+/// accelerated by the speed in the opposite direction.
+template<typename EVEC, uint8_t MAXENC>
+byte
+EncoderSetT<EVEC, MAXENC>::
+_accel(byte i, uint16_t now_ms, bool up)
+{
+    EVEC msk = (EVEC)(((EVEC)1) << i);
+    byte *h = accHist[i];
+    uint16_t dt = (uint16_t)(now_ms - lastStep[i]);
+    byte d = (dt > EncAccel::ACC_IDLE ? EncAccel::ACC_IDLE : (byte)dt);
+    lastStep[i] = now_ms;
+
+    if(up != ((accDir & msk) != 0)) {
+        accDir ^= msk;
+        memset(h, EncAccel::ACC_IDLE, EncAccel::ACC_HIST);
+    }
+    uint16_t sum = d;
+    for(byte k = EncAccel::ACC_HIST-1; k > 0; k--) {
+        h[k] = h[k-1];
+        sum += h[k];
+    }
+    h[0] = d;
+    return EncAccel::mult(accProf[i], (byte)(sum >> EncAccel::ACC_HIST_SHIFT));
+}
+
+/// Set acceleration profile of specified encoder (1..MAXENC; 0 = all)
+template<typename EVEC, uint8_t MAXENC>
+void
+EncoderSetT<EVEC, MAXENC>::
+setAccel(byte n, byte profile)
+{
+    EVEC msk = _mask(n);
+    if(profile >= EncAccel::N_PROFILES) profile = EncAccel::ACC_DEFAULT;
+    for(byte i = 0; i<MAXENC; i++) {
+        if(msk & (((EVEC)1) << i)) {
+            accProf[i] = profile;
+            memset(accHist[i], EncAccel::ACC_IDLE, EncAccel::ACC_HIST);
+        }
+    }
+}
+
 /// Encoder modes
 
 /// Read counter value; resets counter and 'change' flag
+template<typename EVEC, uint8_t MAXENC>
 int
-EncoderSet::getEncCount(byte n, byte reset)
+EncoderSetT<EVEC, MAXENC>::
+getEncCount(byte n, byte reset)
 {
     int res;
     if((n<1) || (n>nencs)) { return 0x0000; }
     n--;
     res = encs.ecount[n];
     if(reset) encs.ecount[n] = 0;
-    encs.changed &= (~(1<<n));
+    encs.changed &= ~(EVEC)(((EVEC)1)<<n);
     return res;
 };     // resets counter and 'change' flag
 
 /// Define number of modes for an encoder.
 /// n = encoder no. (1..nencs)
 /// nmodes = number of modes to assign (0..127)
+template<typename EVEC, uint8_t MAXENC>
 void
-EncoderSet::setNModes(byte n, byte nmodes)
+EncoderSetT<EVEC, MAXENC>::
+setNModes(byte n, byte nmodes)
 {
     // Value 128 (No modes + longpress) not allowed
-    if((n<1)||(n>nencs)||(nmodes==EncoderSet::MODE_LONGPRESS)) { return; }
+    if((n<1)||(n>nencs)||(nmodes==MODE_LONGPRESS)) { return; }
     encs.enmodes[n-1]=nmodes;
 }
 
 /// Set current mode for an encoder.
 /// n = encoder no. (1..nencs)
 /// nmodes = number of modes to assign (0..127)
+template<typename EVEC, uint8_t MAXENC>
 void
-EncoderSet::setMode(byte n, byte nmode)
+EncoderSetT<EVEC, MAXENC>::
+setMode(byte n, byte nmode)
 {
     byte allowed;
     if((n<1) || (n>nencs)) { return; }
     // If nmode is not consistent with the range set with setNMode, call has no effect
     if(nmode == 0) { return; }
-    allowed = (encs.enmodes[n-1]) & ~((byte)EncoderSet::MODE_LONGPRESS);
+    allowed = (encs.enmodes[n-1]) & ~((byte)MODE_LONGPRESS);
     if(allowed == 0) { return; }
     if((allowed > 1) ? (nmode <= allowed) : (nmode < nencs)) {
         encs.enmodes[n-1] = nmode;
@@ -328,21 +477,25 @@ EncoderSet::setMode(byte n, byte nmode)
 
 /// Get current mode for an encoder.
 /// n = encoder no. (1..nencs)
+template<typename EVEC, uint8_t MAXENC>
 byte
-EncoderSet::getMode(byte n)
+EncoderSetT<EVEC, MAXENC>::
+getMode(byte n)
 {
     if((n<1) || (n>nencs)) { return 0xFF; }
     return encs.emode[n-1];
 }
 
 /// Increment (or decrement) current mode for an encoder.
+template<typename EVEC, uint8_t MAXENC>
 void
-EncoderSet::incMode(byte n, byte flags)
+EncoderSetT<EVEC, MAXENC>::
+incMode(byte n, byte flags)
 {
     byte nmax;
     byte nn;
     if((n<1) || (n>nencs)) { return; }
-    nmax = (encs.enmodes[n-1]) & ~((byte)EncoderSet::MODE_LONGPRESS);
+    nmax = (encs.enmodes[n-1]) & ~((byte)MODE_LONGPRESS);
     nn = encs.emode[n-1];
     // flags&0x01: 0->inc, 1->decs
     // flags&0x02: 0->Value stops at edges, 1->Value wraps around
@@ -366,8 +519,5 @@ EncoderSet::incMode(byte n, byte flags)
     encs.emode[n-1] = nn;
 }
 
-// Global instance (singleton use, for embedded)
-//EncoderSet EB = EncoderSet();
-
-/// end class EncoderSet
+/// end class EncoderSetT
 
@@ -21,6 +21,18 @@
 #include "EncManager.h"
 #include "ManagedEnc.h"
 
+ManagedEnc::MEcollector ManagedEnc::_collect = nullptr;
+InputEvents             *ManagedEnc::_events = nullptr;
+
+#ifdef  ME_STATIC_CB
+MEcallback  ManagedEnc::_OnChange   = nullptr;
+MEcallback  ManagedEnc::_OnUp       = nullptr;
+MEcallback  ManagedEnc::_OnDn       = nullptr;
+MEcallback  ManagedEnc::_OnFastUp   = nullptr;
+MEcallback  ManagedEnc::_OnFastDn   = nullptr;
+MEcallback  ManagedEnc::_OnModeChg  = nullptr;
+#endif
+
 ManagedEnc::ManagedEnc(
     uint8_t     index,
     char*       nm,
@@ -108,54 +120,93 @@ void
 ManagedEnc::checkCnt(CountType cnt, uint8_t mode)
 {
     if(cnt != lastCount) {
-        lastDiff = cnt-lastCount;
+        lastDiff = _clampDiff(cnt-lastCount);
         lastCount = cnt;
-        if(_OnChange) _OnChange(this);
+        if(_OnChange) _emit(IEV_CHANGE, lastDiff);
         if(flags & ME_CntToTrn) {
-            uint8_t np = (lastDiff > 0 ? lastDiff : -lastDiff);
-            for (uint8_t i=0; i<np; i++) {
-                if(_OnUp && lastDiff>0) {
-                    _OnUp(this);
-                } else
-                if(_OnDn && lastDiff<0) {
-                    _OnDn(this);
-                }
+            // A single event carries the number of transitions
+            int8_t np = (lastDiff > 0 ? lastDiff : -lastDiff);
+            if(_OnUp && lastDiff>0) {
+                _emit(IEV_UP, np);
+            } else
+            if(_OnDn && lastDiff<0) {
+                _emit(IEV_DN, np);
             }
         }
     }
     if(mode != nMode) {
         nMode = mode;
-        if(_OnModeChg) _OnModeChg(this);
+        if(_OnModeChg) _emit(IEV_MODE, nMode);
     }
 }
 
 void
 ManagedEnc::checkTrn(int8_t dPulses, int8_t dFastPulses, uint8_t mode)
 {
-    lastDiff = dPulses + dFastPulses*fastStep;
-    lastCount += lastDiff;
+    CountType d = dPulses + (CountType)dFastPulses*fastStep;
+    lastCount += d;
+    lastDiff = _clampDiff(d);
     
     if(_OnUp && dPulses>0) {
-        _OnUp(this);
+        _emit(IEV_UP, 1);
     } else
     if(_OnDn && dPulses<0) {
-        _OnDn(this);
+        _emit(IEV_DN, 1);
     }
 
     if(_OnFastUp && dFastPulses>0) {
-        _OnFastUp(this);
+        _emit(IEV_FASTUP, 1);
     } else
     if(_OnFastDn && dFastPulses<0) {
-        _OnFastDn(this);
+        _emit(IEV_FASTDN, 1);
     }
     
     if(mode !=nMode) {
         nMode = mode;
-        if(_OnModeChg) _OnModeChg(this);
+        if(_OnModeChg) _emit(IEV_MODE, nMode);
+    }
+    if((flags & ME_TrnToCnt) && _OnChange) {
+        _emit(IEV_CHANGE, lastDiff);
+    }
+}
+
+void
+ManagedEnc::_emit(uint8_t evt, int8_t n)
+{
+    if(_events) {
+        _events->post(this, IES_ENC | evt, n);
+    } else {
+        _invoke(this, evt, n);
     }
-    if(flags & ME_TrnToCnt) {
-        _OnChange(this);
+}
+
+// A queued count change brings along its own difference: getDiff() returns it in the callback
+void
+ManagedEnc::dispatch(const InputEvent &ev)
+{
+    ManagedEnc *e = (ManagedEnc *)ev.src;
+    uint8_t evt = ev.type & IEV_MASK;
+    if(evt == IEV_CHANGE) e->lastDiff = ev.delta;
+    _invoke(e, evt, ev.delta);
+}
+
+// 'n' is the count difference for IEV_CHANGE, the number of callback invocations
+// for transitions, and the new mode for IEV_MODE
+void
+ManagedEnc::_invoke(ManagedEnc *e, uint8_t evt, int8_t n)
+{
+    MEcallback cb;
+    switch(evt) {
+        case IEV_CHANGE:    cb = e->_OnChange;  n = 1; break;
+        case IEV_UP:        cb = e->_OnUp;      break;
+        case IEV_DN:        cb = e->_OnDn;      break;
+        case IEV_FASTUP:    cb = e->_OnFastUp;  break;
+        case IEV_FASTDN:    cb = e->_OnFastDn;  break;
+        case IEV_MODE:      cb = e->_OnModeChg; n = 1; break;
+        default:            return;
     }
+    if(!cb) return;
+    while(n-- > 0) cb(e);
 }
 
 // END ManagedEnc.cpp
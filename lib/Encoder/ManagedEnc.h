@@ -36,6 +36,7 @@
 #include <Arduino.h>
 #include "boardDefine.h"
 #include "EncManager.h"
+#include "inputEvent.h"
 
 // Define this if callbacks are common to all ManagedEncoders
 #define  ME_STATIC_CB
@@ -66,6 +67,10 @@ private:
     // its public alias "Collect()")
     static MEcollector _collect;
 
+    // If non-null, events are queued here (deferred mode) instead of invoking the callbacks directly;
+    // callbacks are then invoked by the consumer of the queue through dispatch().
+    static InputEvents  *_events;
+
 #ifdef  ME_STATIC_CB
     static MEcallback _OnChange;
     static MEcallback _OnUp;
@@ -92,11 +97,17 @@ private:
     uint8_t     nMode;      // Current mode (used only for change detection)
     uint8_t     nModes;     // Number of modes (used only as storage, accessible for custom inits and operations)
     CountType   lastCount;
-    int8_t      lastDiff;
+    int8_t      lastDiff;   // Last count difference (clamped to +/-127)
     uint8_t     fastStep;
 
     uint8_t     flags;
 
+    // Queue the event (deferred mode) or invoke the callback(s) right away
+    void        _emit(uint8_t evt, int8_t n);
+    static void _invoke(ManagedEnc *e, uint8_t evt, int8_t n);
+
+    static int8_t _clampDiff(CountType d)   { return (int8_t)(d > 127 ? 127 : (d < -127 ? -127 : d)); }
+
 public:
 
     // These constructors allow to define each individual encoder.
@@ -150,6 +161,8 @@ public:
     //     { ManagedEnc* pe = new(p) ManagedEnc; if(_collect != nullptr) _collect(pe); return *pe; }
     static void setCollector(MEcollector cb) { _collect = cb; }
 
+    static void setEventQueue(InputEvents *q) { _events = q; }
+
     ManagedEnc& Collect(void) 
         { if(_collect != nullptr) _collect(this); return *this;}
 
@@ -212,6 +225,11 @@ public:
     // affected transition is invoked only once.
     void    checkTrn(int8_t dPulses, int8_t dFastPulses=0, uint8_t mode=0);
 
+    // Invokes the callback(s) for an event queued in deferred mode (see setEventQueue()).
+    // To be called by the consumer of the event queue.
+    // For count changes, getDiff() returns the difference recorded with the event.
+    static void dispatch(const InputEvent &ev);
+
 };
 
 #endif
@@ -0,0 +1,16 @@
+// =======================================================================
+// @file        FrameClock.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Frame time base for the input processing
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "FrameClock.h"
+
+FrameClock::Source  FrameClock::_src = nullptr;
+uint32_t            FrameClock::_now = 0;
+
+// end FrameClock.cpp
@@ -0,0 +1,60 @@
+// =======================================================================
+// @file        FrameClock.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Frame time base for the input processing
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef FRAMECLOCK_H
+#define FRAMECLOCK_H
+
+#include <Arduino.h>
+
+/// The time (ms) is latched once per scan frame (see ScanScheduler::run()), and all input
+/// components (buttons, encoders, debouncers) take their time from now(): all objects processed
+/// in the same frame see the same time, and millis() is only read once per frame.
+///
+/// The time source is pluggable (setSource()), so that tests can drive a simulated time.
+///
+/// Times are free-running and wrap around: they must only be compared through their difference
+/// (as done by the helpers below), never as "now >= t + delay".
+
+class FrameClock
+{
+    public:
+        using Source = uint32_t (*)(void);
+
+    private:
+        static Source   _src;
+        static uint32_t _now;
+
+    public:
+        // Set the time source (ms); nullptr restores millis().
+        // The time is latched again from the new source.
+        static void     setSource(Source src)   { _src = src; latch(); }
+
+        // Latch the current time; to be called at the start of each scan frame
+        static uint32_t latch(void)             { _now = (_src ? _src() : millis()); return _now; }
+
+        // Time latched for the current frame
+        static uint32_t now(void)               { return _now; }
+        static uint16_t now16(void)             { return (uint16_t)_now; }
+
+        // Current time of the source (not latched)
+        static uint32_t live(void)              { return (_src ? _src() : millis()); }
+
+        // Wrap-safe helpers (valid for intervals up to ~24 days)
+        // Time elapsed since <t>
+        static uint32_t since(uint32_t t)                   { return _now - t; }
+        // True if at least <intv> ms elapsed since <t>
+        static bool     elapsed(uint32_t t, uint32_t intv)  { return (_now - t) >= intv; }
+        // True if time <deadline> was reached
+        static bool     reached(uint32_t deadline)          { return (int32_t)(_now - deadline) >= 0; }
+        // True if time <a> comes after time <b>
+        static bool     after(uint32_t a, uint32_t b)       { return (int32_t)(a - b) > 0; }
+};
+
+#endif // FRAMECLOCK_H
@@ -3,26 +3,30 @@
   Microchip MCP23017 I2C I/O Expander Class for Arduino
 
   Class MCP0: Class for MCP23017 built on base class MCP23x17
-              Implicitly uses Arduino's default I2C (Wire) object (and library)
+              Uses the interrupt-driven TWI transaction queue (TWIQueue)
 
   Based by MCP23S17 class by Cort Buffington & Keith Neufeld
 */
 
 #include "MCP23017.h"            // Header files for this class
 
+bool MCP0::_busInit = false;
+
 // Constructor to instantiate an instance of MCP to a specific chip (address)
 
 MCP0::MCP0(uint8_t hwaddress)
-: MCP(), _ibuf{0}
+: MCP(), _ibuf{0}, _obuf{0}
 {
     config(hwaddress);
+    _rdTx.status = TWI_IDLE;
+    _wrTx.status = TWI_IDLE;
     //init();
 }
 
 void
 MCP0::config(uint8_t hwaddress)
 {
-    _hwaddress = 0x40+((hwaddress<<1)&0x0E);
+    _hwaddress = 0x20+(hwaddress&0x07);
 }
 
 void
@@ -34,49 +38,83 @@ MCP0::init(void)
 void
 MCP0::begin()
 {
+    if(!_busInit) {
+        TWIQueue::begin(400000UL);
+        _busInit = true;
+    }
     MCP::init();
 }
 
+bool
+MCP0::IOReadStart(void)
+{
+    if(_rdTx.status == TWI_PENDING) return false;
+    return TWIQueue::submit(&_rdTx, _hwaddress, MCP_GPIOA, _ibuf, 2, true);
+}
+
+bool
+MCP0::IOWriteStart(unsigned int value)
+{
+    if(_wrTx.status == TWI_PENDING) return false;
+    _obuf[0] = lowByte(value);
+    _obuf[1] = highByte(value);
+    if(!TWIQueue::submit(&_wrTx, _hwaddress, MCP_OLATA, _obuf, 2, false)) return false;
+    _shadow[MCP_SH_OLAT] = value;
+    _dirty &= ~(1 << MCP_SH_OLAT);
+    return true;
+}
+
+// Blocking transfer: queues the transaction and waits for its completion
+void
+MCP0::_transfer(uint8_t regaddr, uint8_t *buf, uint8_t n, bool read)
+{
+    TWItx tx;
+    while(!TWIQueue::submit(&tx, _hwaddress, regaddr, buf, n, read)) {}
+    TWIQueue::wait(&tx);
+}
+
 char
 MCP0::_read(char regaddr)
 {
-	Wire.beginTransmission(_hwaddress);
-	Wire.write(regaddr);
-	Wire.endTransmission(); // false); // for repeated start - required?
-	Wire.requestFrom(_hwaddress, (byte)1);
-	return Wire.read();
+    uint8_t res = 0;
+    _transfer(regaddr, &res, 1, true);
+    return res;
 }
 
 unsigned int
 MCP0::_readW(char regaddr)
 {
-    uint16_t res;
-	Wire.beginTransmission(_hwaddress);
-	Wire.write(regaddr);
-	Wire.endTransmission(); // false); // for repeated start - required?
-	Wire.requestFrom(_hwaddress, (byte)2);
-	res = Wire.read();
-	res <<= 8;
-    res |= (uint8_t)Wire.read();
-    return res;
+    uint8_t buf[2] = {0, 0};
+    _transfer(regaddr, buf, 2, true);
+    return ((unsigned int)buf[1] << 8) | buf[0];    // Format is 0x(portB)(portA)
 }
 
 void
 MCP0::_write(char regaddr, char data)
 {
-	Wire.beginTransmission(_hwaddress);
-	Wire.write(regaddr);
-	Wire.write(data);
-	Wire.endTransmission();
+    uint8_t buf = data;
+    _transfer(regaddr, &buf, 1, false);
 }
 
 void
 MCP0::_writeW(char regaddr, unsigned int data)
 {
-  	Wire.beginTransmission(_hwaddress);
-	Wire.write(regaddr);
-	Wire.write((char)(data&0xFF));
-	Wire.write((char)((data>>8)&0xFF));
-    Wire.endTransmission();
+    uint8_t buf[2];
+    buf[0] = lowByte(data);
+    buf[1] = highByte(data);
+    _transfer(regaddr, buf, 2, false);
+}
+
+// Sequential read of <n> registers
+void
+MCP0::_readN(uint8_t regaddr, uint8_t *buf, uint8_t n)
+{
+    _transfer(regaddr, buf, n, true);
 }
 
+// Sequential write of <n> registers
+void
+MCP0::_writeN(uint8_t regaddr, const uint8_t *buf, uint8_t n)
+{
+    _transfer(regaddr, (uint8_t *)buf, n, false);
+}
@@ -3,7 +3,10 @@
   Microchip MCP23017 I2C I/O Expander Class for Arduino
 
   Class MCP0: Class for MCP23017 built on base class MCP23x17
-              Implicitly uses Arduino's default I2C (Wire) object (and library)
+              Uses the interrupt-driven TWI transaction queue (TWIQueue) rather than Wire:
+              register accesses inherited from MCP are queued and waited for (blocking),
+              while inputs and outputs can also be transferred without blocking
+              (see IOReadStart() / IOWriteStart()).
   
   Based by MCP23S17 class by Cort Buffington & Keith Neufeld
 */
@@ -15,27 +18,49 @@
 //#include <I2C.h>    // Mbed I2C Master library
 #include "MCP23x17.h"
 #include <Arduino.h>
-#include <Wire.h>
+#include "TWIQueue.h"
 
 class MCP0 :
 public MCP
 {
   public:
-    explicit    MCP0(uint8_t hwaddress = 0);    // Beware: HWaddress is 7-bit (will be <<1 by the class)
+    explicit    MCP0(uint8_t hwaddress = 0);    // HWaddress is the value of pins A2..A0 (0..7)
     void        config(uint8_t hwaddress);
     void        init(void)  override;
-    void        begin()     override;       // Get hold of the I2C Bus
+    void        begin()     override;       // Get hold of the I2C Bus (400kHz)
+
+    // Non-blocking input read:
+    // IOReadStart() queues a read of the GPIO registers (returns false if the queue is full);
+    // the result can be fetched with IOReadResult() once IOReadReady() returns true.
+    bool         IOReadStart(void);
+    bool         IOReadReady(void)      { return (_rdTx.status != TWI_PENDING); }
+    bool         IOReadOK(void)         { return (_rdTx.status == TWI_DONE); }
+    unsigned int IOReadResult(void)     { return ((unsigned int)_ibuf[1] << 8) | _ibuf[0]; }
+
+    // Non-blocking output write (also updates the output shadow register).
+    // Returns false if the previous write is still pending or the queue is full.
+    bool         IOWriteStart(unsigned int value);
+    bool         IOWriteReady(void)     { return (_wrTx.status != TWI_PENDING); }
 
   private:
 
+    static bool     _busInit;
+
     // HW address info
-    uint8_t         _hwaddress;
-    char            _ibuf[6];
+    uint8_t         _hwaddress;             // 7-bit I2C address
+    uint8_t         _ibuf[2];               // Async input buffer
+    uint8_t         _obuf[2];               // Async output buffer
+    TWItx           _rdTx;                  // Async input transaction
+    TWItx           _wrTx;                  // Async output transaction
+
+    void            _transfer(uint8_t regaddr, uint8_t *buf, uint8_t n, bool read);
 
     char            _read(char regaddr) override;
     unsigned int    _readW(char regaddr) override;
     void            _write(char regaddr, char data) override;
     void            _writeW(char regaddr, unsigned int data) override;
+    void            _readN(uint8_t regaddr, uint8_t *buf, uint8_t n) override;
+    void            _writeN(uint8_t regaddr, const uint8_t *buf, uint8_t n) override;
 };
 
 #endif //MCP23017
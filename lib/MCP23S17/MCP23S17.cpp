@@ -17,6 +17,11 @@
 // Configuration register: for MCP23S17, the only thing we change is enabling hardware addressing
 #define    ADDR_ENABLE   (0b00001000)  
 
+const SPISettings MCPS::_SPIset(1000000, MSBFIRST, SPI_MODE0);
+bool              MCPS::_session  = false;
+volatile bool     MCPS::_busy     = false;
+uint16_t          MCPS::_txSetups = 0;
+
 // Constructor to instantiate an instance of MCP to a specific chip (address)
 // Requires init() (or begin()) to be called later
 MCPS::MCPS(uint8_t hwaddress, uint8_t nCs_pin, uint8_t nReset_pin)
@@ -63,6 +68,46 @@ MCPS::begin() {
     MCP::init();
 }
 
+void
+MCPS::busBegin(void)
+{
+    if(_session) return;
+    _busy = true;
+    SPI.beginTransaction(_SPIset);
+    _txSetups++;
+    _session = true;
+}
+
+void
+MCPS::busEnd(void)
+{
+    if(!_session) return;
+    _session = false;
+    SPI.endTransaction();
+    _busy = false;
+}
+
+void
+MCPS::_beginTx(void)
+{
+    if(!_session) {
+        _busy = true;
+        SPI.beginTransaction(_SPIset);
+        _txSetups++;
+    }
+    ::digitalWrite(_ss, LOW);
+}
+
+void
+MCPS::_endTx(void)
+{
+    ::digitalWrite(_ss, HIGH);
+    if(!_session) {
+        SPI.endTransaction();
+        _busy = false;
+    }
+}
+
 void
 MCPS::_make_opcode(uint8_t hwaddr)
 {
@@ -74,13 +119,11 @@ char
 MCPS::_read(char regaddr)
 {
     uint8_t value = 0;                          // Initialize a variable to hold the read values to be returned
-    SPI.beginTransaction(_SPIset);              // Start up the SPI bus
-    ::digitalWrite(_ss, LOW);                   // Take slave-select low
+    _beginTx();                                 // Start up the SPI bus, take slave-select low
     SPI.transfer(_readopcode);                  // Send the MCP23S17 opcode, chip address, and read bit
     SPI.transfer(regaddr);                      // Send the register we want to read
     value = SPI.transfer(0xFF);                 // Send any byte, the function will return the read value
-    ::digitalWrite(_ss, HIGH);                  // Take slave-select high
-    SPI.endTransaction();
+    _endTx();                                   // Take slave-select high, release the SPI bus
     return value;                               // Return the constructed word, the format is 0x(register value)
 }
 
@@ -88,40 +131,55 @@ unsigned int
 MCPS::_readW(char regaddr)
 {
     uint16_t value = 0;                     // Initialize a variable to hold the read values to be returned
-    SPI.beginTransaction(_SPIset);          // Start up the SPI bus
-    ::digitalWrite(_ss, LOW);               // Take slave-select low
+    _beginTx();                             // Start up the SPI bus, take slave-select low
     SPI.transfer(_readopcode);              // Send the MCP23S17 opcode, chip address, and read bit
     SPI.transfer(regaddr);                  // Send the register we want to read
     value = SPI.transfer(0xFF);             // Send any byte, the function will return the read value (register address pointer will auto-increment after write)
     value |= ((uint16_t)SPI.transfer(0xFF))<<8; // Read in the "high byte" (portB) and shift it up to the high location and merge with the "low byte"
-    ::digitalWrite(_ss, HIGH);              // Take slave-select high
-    SPI.endTransaction();
+    _endTx();                               // Take slave-select high, release the SPI bus
     return value;                           // Return the constructed word, the format is 0x(portB)(portA)
 }
 
 void
 MCPS::_write(char regaddr, char data)
 {
-    SPI.beginTransaction(_SPIset);  // Start up the SPI bus
-    ::digitalWrite(_ss, LOW);       // Take slave-select low
+    _beginTx();                     // Start up the SPI bus, take slave-select low
     SPI.transfer(_writeopcode);     // Send the MCP23S17 opcode, chip address, and write bit
     SPI.transfer(regaddr);          // Send the register we want to write
     SPI.transfer(data);             // Send the byte
-    ::digitalWrite(_ss, HIGH);      // Take slave-select high
-    SPI.endTransaction();
+    _endTx();                       // Take slave-select high, release the SPI bus
 }
 
 void
 MCPS::_writeW(char regaddr, unsigned int data)
 {
-    SPI.beginTransaction(_SPIset);          // Start up the SPI bus
-    ::digitalWrite(_ss, LOW);               // Take slave-select low
+    _beginTx();                             // Start up the SPI bus, take slave-select low
     SPI.transfer(_writeopcode);             // Send the MCP23S17 opcode, chip address, and write bit
     SPI.transfer(regaddr);                  // Send the register we want to write
     SPI.transfer((char)(data&0xFF));        // Send the low byte (register address pointer will auto-increment after write)
     SPI.transfer((char)((data>>8)&0xFF));   // Shift the high byte down to the low byte location and send
-    ::digitalWrite(_ss, HIGH);              // Take slave-select high
-    SPI.endTransaction();
+    _endTx();                               // Take slave-select high, release the SPI bus
 }
 
+// Sequential read of <n> registers in a single SS-low window (requires IOCON.SEQOP=0)
+void
+MCPS::_readN(uint8_t regaddr, uint8_t *buf, uint8_t n)
+{
+    _beginTx();                             // Start up the SPI bus, take slave-select low
+    SPI.transfer(_readopcode);              // Send the MCP23S17 opcode, chip address, and read bit
+    SPI.transfer(regaddr);                  // Send the first register we want to read
+    while(n--) *buf++ = SPI.transfer(0xFF); // Register address pointer auto-increments after each byte
+    _endTx();                               // Take slave-select high, release the SPI bus
+}
+
+// Sequential write of <n> registers in a single SS-low window (requires IOCON.SEQOP=0)
+void
+MCPS::_writeN(uint8_t regaddr, const uint8_t *buf, uint8_t n)
+{
+    _beginTx();                             // Start up the SPI bus, take slave-select low
+    SPI.transfer(_writeopcode);             // Send the MCP23S17 opcode, chip address, and write bit
+    SPI.transfer(regaddr);                  // Send the first register we want to write
+    while(n--) SPI.transfer(*buf++);        // Register address pointer auto-increments after each byte
+    _endTx();                               // Take slave-select high, release the SPI bus
+}
 
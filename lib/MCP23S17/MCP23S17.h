@@ -25,12 +25,30 @@ public MCP
     void     init(void)  override;
     void     begin(void) override;
 
+    // Bus session: acquires the SPI bus (with the expander settings) once for a whole batch of
+    // operations on any number of chips; within a session, each operation only toggles its CS line.
+    // Sessions do not nest. No other SPI device may be accessed between busBegin() and busEnd().
+    static void     busBegin(void);
+    static void     busEnd(void);
+    static bool     busBusy(void)           { return _busy; }
+
+    // Number of SPI transaction setups performed (for bus overhead statistics)
+    static uint16_t getTxSetups(void)       { return _txSetups; }
+    static void     clearTxSetups(void)     { _txSetups = 0; }
+
   private:
 
+    static const SPISettings _SPIset;       // will be passed at each SPI transaction begin
+    static bool          _session;          // A bus session is open
+    static volatile bool _busy;             // The SPI bus is currently held (in a session or single operation)
+    static uint16_t      _txSetups;
+
+    void         _beginTx(void);
+    void         _endTx(void);
+
     uint8_t     _address;   // Address of the MCP23S17 in use
 	uint8_t     _ss;        // Slave-select pin
 	uint8_t     _rst;       // Reset pin
-    const SPISettings _SPIset = { 1000000, MSBFIRST, SPI_MODE0 }; // will be passed at each SPI transaction begin
 
     // HW address info
     uint8_t      _writeopcode;
@@ -41,6 +59,8 @@ public MCP
     unsigned int _readW(char regaddr) override;
     void         _write(char regaddr, char data) override;
     void         _writeW(char regaddr, unsigned int data) override;
+    void         _readN(uint8_t regaddr, uint8_t *buf, uint8_t n) override;
+    void         _writeN(uint8_t regaddr, const uint8_t *buf, uint8_t n) override;
 };
 
 #endif //MCP23S17
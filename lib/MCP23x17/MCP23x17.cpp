@@ -32,6 +32,7 @@
 // Constructor to instantiate an instance of MCP to a specific chip (address)
 
 MCP::MCP(void)
+: _dirty(0), _deferred(false)
 {
     // init(); // Init must be performed by derived classes - tx must already be setup!
 }
@@ -40,18 +41,86 @@ void
 MCP::init(void)
 {
     uint8_t  ctr;
-    _modeCache   = 0xFFFF;      // Default I/O mode is all input, 0xFFFF
-    _outputCache = 0x0000;      // Default output state is all off, 0x0000
-    _pullupCache = 0x0000;      // Default pull-up state is all off, 0x0000
-    _invertCache = 0xFFFF;      // Default input inversion state is inverted, 0xFFFF
-    ctr = 0x0E;                 // setup of control register (BANK = 0, MIRROR = 0, SEQOP = 0, DISSLW = 0, HAEN = 1, ODR = 1, INTPOL = 1, NC = 0)
-    _write(MCP_IOCON, ctr);
-    _writeW(MCP_IODIRA, _modeCache);
-    _writeW(MCP_GPPUA, _pullupCache);
-    _writeW(MCP_IPOLA, _invertCache);
+    _shadow[MCP_SH_IODIR]   = 0xFFFF;   // Default I/O mode is all input, 0xFFFF
+    _shadow[MCP_SH_IPOL]    = 0xFFFF;   // Default input inversion state is inverted, 0xFFFF
+    _shadow[MCP_SH_GPINTEN] = 0x0000;   // Default interrupt-on-change is off, 0x0000
+    _shadow[MCP_SH_DEFVAL]  = 0x0000;
+    _shadow[MCP_SH_INTCON]  = 0x0000;   // Interrupt compare against previous value
+    _shadow[MCP_SH_GPPU]    = 0x0000;   // Default pull-up state is all off, 0x0000
+    _shadow[MCP_SH_OLAT]    = 0x0000;   // Default output state is all off, 0x0000
+    ctr = 0x0E;                         // setup of control register (BANK = 0, MIRROR = 0, SEQOP = 0, DISSLW = 0, HAEN = 1, ODR = 1, INTPOL = 1, NC = 0)
+    _shadow[MCP_SH_IOCON]   = ctr | (ctr << 8);
+    _write(MCP_IOCON, ctr);             // Written alone first, to make sure that sequential mode is on
+    // Whole register file is written at once
+    _dirty = 0xFF;
+    commit();
+}
+
+// SHADOW REGISTER FILE
+
+// Updates a register pair in the shadow; it is marked for writing only if its value has changed.
+// Unless deferred, the change is written immediately.
+void
+MCP::_setReg(uint8_t idx, unsigned int value) {
+  if (_shadow[idx] != value) {
+    _shadow[idx] = value;
+    _dirty |= (1 << idx);
+  }
+  if (!_deferred) commit();
+}
+
+void
+MCP::_setBit(uint8_t idx, uint8_t pin, uint8_t on) {
+  unsigned int v = _shadow[idx];
+  if (on) {
+    v |= 1 << (pin - 1);
+  } else {
+    v &= ~(1 << (pin - 1));
+  }
+  _setReg(idx, v);
+}
+
+void
+MCP::defer(bool on) {
+  _deferred = on;
+  if (!on) commit();
+}
+
+// Writes all changed register pairs. Runs of contiguous changed pairs in the configuration block
+// (0x00..0x0D) are merged into a single burst; a single unchanged pair between two changed ones is
+// rewritten rather than splitting the burst, since that is cheaper than a new transaction.
+void
+MCP::commit(void) {
+  uint8_t buf[2*MCP_SH_OLAT];
+  uint8_t first, last, n;
+
+  if (_dirty == 0) return;
+
+  first = 0;
+  while (first < MCP_SH_OLAT) {
+    if (!(_dirty & (1 << first))) { first++; continue; }
+    last = first;
+    while (last+1 < MCP_SH_OLAT &&
+           ((_dirty & (1 << (last+1))) ||
+            (last+2 < MCP_SH_OLAT && (_dirty & (1 << (last+2)))))) {
+      last++;
+    }
+    n = 0;
+    for (uint8_t i = first; i <= last; i++) {
+      buf[n++] = lowByte(_shadow[i]);
+      buf[n++] = highByte(_shadow[i]);
+    }
+    _writeN(first << 1, buf, n);
+    first = last+1;
+  }
+  if (_dirty & (1 << MCP_SH_OLAT)) {
+    _writeW(MCP_OLATA, _shadow[MCP_SH_OLAT]);
+  }
+  _dirty = 0;
 }
 
 // GENERIC BYTE WRITE - will write a byte to a register, arguments are register address and the value to write
+// (Bypasses the shadow register file)
 
 void
 MCP::byteWrite(uint8_t reg, uint8_t value) {      // Accept the register and byte
@@ -59,31 +128,46 @@ MCP::byteWrite(uint8_t reg, uint8_t value) {      // Accept the register and byt
 }
 
 // GENERIC WORD WRITE - will write a word to a register pair, LSB to first register, MSB to next higher value register
+// (Bypasses the shadow register file)
 
 void
 MCP::wordWrite(uint8_t reg, unsigned int word) {  // Accept the start register and word
     _writeW(reg, word);
 }
 
+// BURST READ/WRITE - will read/write <n> contiguous registers starting from the given one, in a single transaction
+// (Bypasses the shadow register file)
+
+void
+MCP::burstRead(uint8_t reg, uint8_t *buf, uint8_t n) {
+    _readN(reg, buf, n);
+}
+
+void
+MCP::burstWrite(uint8_t reg, const uint8_t *buf, uint8_t n) {
+    _writeN(reg, buf, n);
+}
+
 // MODE SETTING FUNCTIONS - BY PIN AND BY WORD
 
 void
 MCP::pinMode(uint8_t pin, uint8_t mode) {  // Accept the pin # and I/O mode
   if ((pin < 1) || (pin > 16)) return;               // If the pin value is not valid (1-16) return, do nothing and return
+  bool d = _deferred;
+  _deferred = true;                                 // Pull-up and mode are committed together
   if (mode == INPUT ||
-      mode == INPUT_PULLUP ) {                  // Determine the mode before changing the bit state in the mode cache
-    _modeCache |= 1 << (pin - 1);               // Since input = "HIGH", OR in a 1 in the appropriate place
+      mode == INPUT_PULLUP ) {                  // Determine the mode before changing the bit state in the mode shadow
+    _setBit(MCP_SH_IODIR, pin, 1);              // Since input = "HIGH", OR in a 1 in the appropriate place
     pullupMode(pin, (mode == INPUT_PULLUP));
   } else {
-    _modeCache &= ~(1 << (pin - 1));            // If not, the mode must be output, so and in a 0 in the appropriate place
+    _setBit(MCP_SH_IODIR, pin, 0);              // If not, the mode must be output, so and in a 0 in the appropriate place
   }
-  _writeW(MCP_IODIRA, _modeCache);                // Call the generic word writer with start register and the mode cache
+  defer(d);
 }
 
 void
 MCP::pinMode(unsigned int mode) {     // Accept the word…
-  _writeW(MCP_IODIRA, mode);                // Call the the generic word writer with start register and the mode cache
-  _modeCache = mode;
+  _setReg(MCP_SH_IODIR, mode);
 }
 
 // THE FOLLOWING WRITE FUNCTIONS ARE NEARLY IDENTICAL TO THE FIRST AND ARE NOT INDIVIDUALLY COMMENTED
@@ -93,19 +177,13 @@ MCP::pinMode(unsigned int mode) {     // Accept the word…
 void
 MCP::pullupMode(uint8_t pin, uint8_t mode) {
   if ((pin < 1) || (pin > 16)) return;
-  if (mode) {
-    _pullupCache |= 1 << (pin - 1);
-  } else {
-    _pullupCache &= ~(1 << (pin -1));
-  }
-  _writeW(MCP_GPPUA, _pullupCache);
+  _setBit(MCP_SH_GPPU, pin, mode);
 }
 
 
 void
 MCP::pullupMode(unsigned int mode) {
-  _writeW(MCP_GPPUA, mode);
-  _pullupCache = mode;
+  _setReg(MCP_SH_GPPU, mode);
 }
 
 
@@ -113,37 +191,37 @@ MCP::pullupMode(unsigned int mode) {
 void
 MCP::inputInvert(uint8_t pin, uint8_t mode) {
   if ((pin < 1) || (pin > 16)) return;
-  if (mode == ON) {
-    _invertCache |= 1 << (pin - 1);
-  } else {
-    _invertCache &= ~(1 << (pin - 1));
-  }
-  _writeW(MCP_IPOLA, _invertCache);
+  _setBit(MCP_SH_IPOL, pin, (mode == ON));
 }
 
 void
 MCP::inputInvert(unsigned int mode) {
-  _writeW(MCP_IPOLA, mode);
-  _invertCache = mode;
+  _setReg(MCP_SH_IPOL, mode);
+}
+
+// WHOLE CONFIGURATION SETTING - mode, pull-ups and inversion in a single commit
+void
+MCP::configure(unsigned int mode, unsigned int pullup, unsigned int invert) {
+  bool d = _deferred;
+  _deferred = true;
+  _setReg(MCP_SH_IODIR, mode);
+  _setReg(MCP_SH_GPPU,  pullup);
+  _setReg(MCP_SH_IPOL,  invert);
+  defer(d);
 }
 
 
 // WRITE FUNCTIONS - BY WORD AND BY PIN
+// (Outputs are written to OLAT, which is equivalent to writing GPIO)
 void
 MCP::IOWrite(unsigned int value) {
-  _writeW(MCP_GPIOA, value);
-  _outputCache = value;
+  _setReg(MCP_SH_OLAT, value);
 }
 
 void
 MCP::IOWrite(uint8_t pin, uint8_t value) {
   if ((pin < 1) || (pin > 16)) return;
-  if (value) {
-    _outputCache |= 1 << (pin - 1);
-  } else {
-    _outputCache &= ~(1 << (pin - 1));
-  }
-  _writeW(MCP_GPIOA, _outputCache);
+  _setBit(MCP_SH_OLAT, pin, value);
 }
 
 
@@ -161,78 +239,60 @@ MCP::IORead(void) {       // This function will read all 16 bits of I/O, and ret
 uint8_t
 MCP::IORead(uint8_t pin) {                    // Return a single bit value, supply the necessary bit (1-16)
     if ((pin < 1) || (pin > 16)) return 0x0;                    // If the pin value is not valid (1-16) return, do nothing and return
-    return (digitalRead() & (1 << (pin - 1))) ? HIGH : LOW;  // Call the word reading function, extract HIGH/LOW information from the requested pin
+    return (IORead() & (1 << (pin - 1))) ? HIGH : LOW;  // Call the word reading function, extract HIGH/LOW information from the requested pin
 }
 
-/// Following section is from Adafruit's MCP23017 library - 
-/// serves as sample for future implementation of interrupt management, currently missing.
+// INTERRUPT FUNCTIONS
 
-/*
-// Configures the interrupt system. both port A and B are assigned the same configuration.
-// Mirroring will OR both INTA and INTB pins.
-// Opendrain will set the INT pin to value or open drain.
-// polarity will set LOW or HIGH on interrupt.
-// Default values after Power On Reset are: (false,flase, LOW)
-// If you are connecting the INTA/B pin to arduino 2/3, you should configure the interupt handling as FALLING with
-// the default configuration.
-
-void Adafruit_MCP23017::setupInterrupts(uint8_t mirroring, uint8_t openDrain, uint8_t polarity){
-	// configure the port A
-	uint8_t ioconfValue=readRegister(MCP23017_IOCONA);
-	bitWrite(ioconfValue,6,mirroring);
-	bitWrite(ioconfValue,2,openDrain);
-	bitWrite(ioconfValue,1,polarity);
-	writeRegister(MCP23017_IOCONA,ioconfValue);
-
-	// Configure the port B
-	ioconfValue=readRegister(MCP23017_IOCONB);
-	bitWrite(ioconfValue,6,mirroring);
-	bitWrite(ioconfValue,2,openDrain);
-	bitWrite(ioconfValue,1,polarity);
-	writeRegister(MCP23017_IOCONB,ioconfValue);
+// Configures the interrupt system; both port A and B are assigned the same configuration.
+// Mirroring will OR both INTA and INTB pins (required when a single IRQ line per chip is wired).
+// OpenDrain will set the INT pins to open drain (overrides polarity); this allows several chips
+// to share the same (pulled-up) IRQ line, which is then active LOW.
+void
+MCP::setupInterrupts(uint8_t mirroring, uint8_t openDrain, uint8_t polarity) {
+  uint8_t ctr = lowByte(_shadow[MCP_SH_IOCON]);
+  bitWrite(ctr, 6, (mirroring != 0));
+  bitWrite(ctr, 2, (openDrain != 0));
+  bitWrite(ctr, 1, (polarity != 0));
+  _setReg(MCP_SH_IOCON, ctr | (ctr << 8));      // Both addresses map the same register
 }
 
-
-// Set up a pin for interrupt. uses arduino MODEs: CHANGE, FALLING, RISING.
-// Note that the interrupt condition finishes when you read the information about the port / value
-// that caused the interrupt or you read the port itself. Check the datasheet can be confusing.
-
-void Adafruit_MCP23017::setupInterruptPin(uint8_t pin, uint8_t mode) {
-
-	// set the pin interrupt control (0 means change, 1 means compare against given value);
-	updateRegisterBit(pin,(mode!=CHANGE),MCP23017_INTCONA,MCP23017_INTCONB);
-	// if the mode is not CHANGE, we need to set up a default value, different value triggers interrupt
-
-	// In a RISING interrupt the default value is 0, interrupt is triggered when the pin goes to 1.
-	// In a FALLING interrupt the default value is 1, interrupt is triggered when pin goes to 0.
-	updateRegisterBit(pin,(mode==FALLING),MCP23017_DEFVALA,MCP23017_DEFVALB);
-
-	// enable the pin for interrupt
-	updateRegisterBit(pin,HIGH,MCP23017_GPINTENA,MCP23017_GPINTENB);
+// Enables interrupt-on-change for the pins set in 'enable'.
+// 'compare' selects pins compared against 'defval' (1) rather than against their previous state (0).
+// Only pins configured as inputs should be enabled.
+void
+MCP::interruptMode(unsigned int enable, unsigned int compare, unsigned int defval) {
+  bool d = _deferred;
+  _deferred = true;
+  _setReg(MCP_SH_DEFVAL,  defval);
+  _setReg(MCP_SH_INTCON,  compare);
+  _setReg(MCP_SH_GPINTEN, enable);
+  defer(d);
 }
 
-uint8_t Adafruit_MCP23017::getLastInterruptPin(){
-	uint8_t intf;
-
-	// try port A
-	intf=readRegister(MCP23017_INTFA);
-	for(int i=0;i<8;i++) if (bitRead(intf,i)) return i;
-
-	// try port B
-	intf=readRegister(MCP23017_INTFB);
-	for(int i=0;i<8;i++) if (bitRead(intf,i)) return i+8;
+unsigned int
+MCP::getIntFlags(void) {
+  return _readW(MCP_INTFA);
+}
 
-	return MCP23017_INT_ERR;
+unsigned int
+MCP::getIntCapture(void) {
+  return _readW(MCP_INTCAPA);
+}
 
+unsigned int
+MCP::getIntState(unsigned int &capture) {
+  uint8_t buf[4];     // INTFA, INTFB, INTCAPA, INTCAPB
+  _readN(MCP_INTFA, buf, 4);
+  capture = ((unsigned int)buf[3] << 8) | buf[2];
+  return ((unsigned int)buf[1] << 8) | buf[0];
 }
-uint8_t Adafruit_MCP23017::getLastInterruptPinValue(){
-	uint8_t intPin=getLastInterruptPin();
-	if(intPin!=MCP23017_INT_ERR){
-		uint8_t intcapreg=regForPin(intPin,MCP23017_INTCAPA,MCP23017_INTCAPB);
-		uint8_t bit=bitForPin(intPin);
-		return (readRegister(intcapreg)>>bit) & (0x01);
-	}
 
-	return MCP23017_INT_ERR;
+unsigned int
+MCP::getIntState(unsigned int &capture, unsigned int &gpio) {
+  uint8_t buf[6];     // INTFA, INTFB, INTCAPA, INTCAPB, GPIOA, GPIOB
+  _readN(MCP_INTFA, buf, 6);
+  capture = ((unsigned int)buf[3] << 8) | buf[2];
+  gpio    = ((unsigned int)buf[5] << 8) | buf[4];
+  return ((unsigned int)buf[1] << 8) | buf[0];
 }
-*/
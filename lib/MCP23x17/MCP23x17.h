@@ -12,8 +12,9 @@
     Input inversion
     Output write
     Input read
-
-  Interrupt features are not implemented in this version
+    Interrupt-on-change (configuration by word, INTF/INTCAP readout)
+    Burst (sequential address) register read/write
+    Shadow register file with deferred, write-combining commit
 
   NOTE:  Addresses below are only valid when IOCON.BANK=0 (register addressing mode)
          This means one of the control register values can change register addresses!
@@ -24,6 +25,14 @@
 
          *THIS CLASS ENABLES THE ADDRESS PINS ON ALL CHIPS ON THE BUS WHEN THE FIRST CHIP OBJECT IS INSTANTIATED!
 
+         Sequential operation (IOCON.SEQOP=0) is kept enabled, so that a contiguous register range
+         can be read or written in a single bus transaction (see burstRead/burstWrite).
+
+         All configuration registers (0x00..0x0D) and the output latch are kept in a shadow register file.
+         Setters only update the shadow, and only pairs whose value has changed are marked for writing;
+         they are written immediately, unless defer(true) has been called: in that case, nothing is
+         transferred until commit() (or defer(false)), which merges contiguous changed pairs in bursts.
+
   USAGE: All Read/Write functions except wordWrite are implemented in two different ways.
          Individual pin values are set by referencing "pin #" and On/Off, Input/Output or High/Low where
          portA represents pins 0-7 and portB 8-15. So to set the most significant bit of portB, set pin # 15.
@@ -75,9 +84,15 @@ class MCP {
     virtual void init(void);
     virtual void begin(void) {};            // Start the Bus if required. Blank unless redefined by derived classes
 
+    void defer(bool);                       // When on, setters only update the shadow registers until commit(); turning it off commits
+    void commit(void);                      // Writes all shadow registers changed since the last commit
+    void invalidate(void)   { _dirty = 0xFF; }  // Marks all shadow registers for writing at the next commit (for periodic re-sync)
+
     uint8_t byteRead(uint8_t);              // Reads an individual register and returns the byte. Argument is the register address
-    void wordWrite(uint8_t, unsigned int);  // Allows the user to write any register pair if needed, so it's a public wrapper
-    void byteWrite(uint8_t, uint8_t);       // Allows the user to write any register if needed, so it's a public wrapper
+    void wordWrite(uint8_t, unsigned int);  // Allows the user to write any register pair if needed, so it's a public wrapper (bypasses the shadow)
+    void byteWrite(uint8_t, uint8_t);       // Allows the user to write any register if needed, so it's a public wrapper (bypasses the shadow)
+    void burstRead(uint8_t, uint8_t*, uint8_t);         // Reads <n> contiguous registers from the start register into a buffer, in a single transaction
+    void burstWrite(uint8_t, const uint8_t*, uint8_t);  // Writes <n> contiguous registers from the start register from a buffer, in a single transaction
 
     void pinMode(uint8_t, uint8_t);         // Sets the mode (input or output) of a single I/O pin
     void pinMode(unsigned int);             // Sets the mode (input or output) of all I/O pins at once
@@ -88,35 +103,49 @@ class MCP {
     void inputInvert(uint8_t, uint8_t);     // Selects input state inversion of a single I/O pin (writing 1 turns on inversion)
     void inputInvert(unsigned int);         // Selects input state inversion of all I/O pins at once (writing a 1 turns on inversion)
 
+    void configure(unsigned int mode, unsigned int pullup, unsigned int invert);   // Sets I/O mode, pull-ups and inversion of all pins in a single commit
+
     uint8_t      IORead(uint8_t);           // Reads an individual input pin
     unsigned int IORead(void);              // Reads all input pins at once. Be sure it ignore the value of pins configured as output!
 
     void IOWrite(uint8_t, uint8_t);         // Sets an individual output pin HIGH or LOW
     void IOWrite(unsigned int);             // Sets all output pins at once. If some pins are configured as input, those bits will be ignored on write
 
+    // Interrupt-on-change
+    void setupInterrupts(uint8_t mirroring, uint8_t openDrain, uint8_t polarity);   // IOCON: MIRROR (INTA/INTB OR'ed), ODR, INTPOL
+    void interruptMode(unsigned int enable, unsigned int compare = 0, unsigned int defval = 0); // GPINTEN, INTCON, DEFVAL for all I/O pins at once
+    unsigned int getIntFlags(void);         // INTF: pins which triggered the interrupt
+    unsigned int getIntCapture(void);       // INTCAP: state of the pins at the time of the interrupt. Reading clears the interrupt!
+    unsigned int getIntState(unsigned int &capture);    // Reads INTF (returned) and INTCAP in a single transaction. Clears the interrupt!
+    unsigned int getIntState(unsigned int &capture, unsigned int &gpio);    // Same as above, also reading GPIO in the same transaction
+
   protected:
-    unsigned int _modeCache;                // Caches the mode (input/output) configuration of I/O pins
-    unsigned int _pullupCache;              // Caches the internal pull-up configuration of input pins (values persist across mode changes)
-    unsigned int _invertCache;              // Caches the input pin inversion selection (values persist across mode changes)
-    unsigned int _outputCache;              // Caches the output pin state of pins
+    // Shadow register file: indexes of register pairs (index = address>>1 for the configuration block)
+    enum {
+        MCP_SH_IODIR = 0,
+        MCP_SH_IPOL,
+        MCP_SH_GPINTEN,
+        MCP_SH_DEFVAL,
+        MCP_SH_INTCON,
+        MCP_SH_IOCON,
+        MCP_SH_GPPU,
+        MCP_SH_OLAT,                        // Not contiguous to the others (0x14)
+        MCP_SH_SIZE
+    };
+    unsigned int _shadow[MCP_SH_SIZE];      // Register pair values, format 0x(portB)(portA)
+    uint8_t      _dirty;                    // Bit mask of the shadow pairs to be written
+    bool         _deferred;                 // Writes are held until commit()
+
+    void _setReg(uint8_t idx, unsigned int value);
+    void _setBit(uint8_t idx, uint8_t pin, uint8_t on);     // pin = 1..16
 
     // Pure virtual functions to be defined by the actual (derived) classes
     virtual char            _read(char regaddr)=0;
     virtual unsigned int    _readW(char regaddr)=0;
     virtual void            _write(char regaddr, char data)=0;
     virtual void            _writeW(char regaddr, unsigned int data)=0;
+    virtual void            _readN(uint8_t regaddr, uint8_t *buf, uint8_t n)=0;
+    virtual void            _writeN(uint8_t regaddr, const uint8_t *buf, uint8_t n)=0;
 };
 
-/// Following section is from Adafruit's MCP23017 library -
-/// serves as sample for future implementation of interrupt management, currently missing.
-/*
-#define MCP23017_INT_ERR 0xFF
-
-    void setupInterrupts(uint8_t mirroring, uint8_t open, uint8_t polarity);
-    void setupInterruptPin(uint8_t p, uint8_t mode);
-    uint8_t getLastInterruptPin(void);
-    uint8_t getLastInterruptPinValue(void);
-*/
-
-
 #endif //MCP23S17
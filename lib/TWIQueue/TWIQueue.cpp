@@ -0,0 +1,169 @@
+// =======================================================================
+// @file        TWIQueue.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Non-blocking, interrupt-driven I2C (TWI) master for AVR
+//              with a queue of register transactions
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "TWIQueue.h"
+#include <avr/interrupt.h>
+#include <util/twi.h>
+
+// TWCR command values
+#define TWCR_ACK    (_BV(TWINT) | _BV(TWEN) | _BV(TWIE) | _BV(TWEA))
+#define TWCR_NACK   (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+#define TWCR_SEND   TWCR_NACK
+#define TWCR_START  (_BV(TWINT) | _BV(TWEN) | _BV(TWIE) | _BV(TWSTA))
+#define TWCR_STOP   (_BV(TWINT) | _BV(TWEN) | _BV(TWSTO))
+#define TWCR_STOPSTART  (_BV(TWINT) | _BV(TWEN) | _BV(TWIE) | _BV(TWSTO) | _BV(TWSTA))
+
+TWItx*   volatile TWIQueue::_queue[QSIZE];
+volatile uint8_t  TWIQueue::_head = 0;
+volatile uint8_t  TWIQueue::_tail = 0;
+uint8_t           TWIQueue::_idx = 0;
+bool              TWIQueue::_regSent = false;
+uint16_t          TWIQueue::_errors = 0;
+
+void
+TWIQueue::begin(uint32_t freq)
+{
+    // Internal pull-ups on SDA/SCL (external ones are recommended anyway at 400kHz)
+    digitalWrite(SDA, HIGH);
+    digitalWrite(SCL, HIGH);
+    // Prescaler = 1: SCL = F_CPU / (16 + 2*TWBR)
+    TWSR = 0;
+    TWBR = (uint8_t)(((F_CPU / freq) - 16) / 2);
+    TWCR = _BV(TWEN);
+    _head = _tail = 0;
+}
+
+bool
+TWIQueue::submit(TWItx *t)
+{
+    if(t->read && t->len == 0) return false;
+
+    uint8_t sreg = SREG;
+    cli();
+    if(pending() >= QSIZE) {
+        SREG = sreg;
+        return false;
+    }
+    bool wasIdle = idle();
+    t->status = TWI_PENDING;
+    _queue[_head & (QSIZE-1)] = t;
+    _head++;
+    if(wasIdle) _start();
+    SREG = sreg;
+    return true;
+}
+
+bool
+TWIQueue::submit(TWItx *t, uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len, bool read)
+{
+    t->addr = addr;
+    t->reg  = reg;
+    t->buf  = buf;
+    t->len  = len;
+    t->read = read;
+    return submit(t);
+}
+
+// Waits with interrupts enabled: must not be called from an ISR
+bool
+TWIQueue::wait(TWItx *t)
+{
+    while(t->status == TWI_PENDING) {}
+    return (t->status == TWI_DONE);
+}
+
+void
+TWIQueue::_start(void)
+{
+    _idx = 0;
+    _regSent = false;
+    // Previous STOP (if any) must be completed before issuing a new START
+    while(TWCR & _BV(TWSTO)) {}
+    TWCR = TWCR_START;
+}
+
+void
+TWIQueue::_finish(uint8_t status)
+{
+    _queue[_tail & (QSIZE-1)]->status = status;
+    _tail++;
+    if(_head != _tail) {
+        // Chain the next transaction: STOP followed by START
+        _idx = 0;
+        _regSent = false;
+        TWCR = TWCR_STOPSTART;
+    } else {
+        TWCR = TWCR_STOP;
+    }
+}
+
+void
+TWIQueue::_isr(void)
+{
+    TWItx *t = _queue[_tail & (QSIZE-1)];
+
+    switch(TW_STATUS) {
+
+    case TW_START:
+        TWDR = (t->addr << 1) | TW_WRITE;
+        TWCR = TWCR_SEND;
+        break;
+
+    case TW_REP_START:
+        TWDR = (t->addr << 1) | TW_READ;
+        TWCR = TWCR_SEND;
+        break;
+
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+        if(!_regSent) {
+            TWDR = t->reg;
+            _regSent = true;
+            TWCR = TWCR_SEND;
+        } else if(t->read) {
+            TWCR = TWCR_START;          // Repeated start for the read phase
+        } else if(_idx < t->len) {
+            TWDR = t->buf[_idx++];
+            TWCR = TWCR_SEND;
+        } else {
+            _finish(TWI_DONE);
+        }
+        break;
+
+    case TW_MR_SLA_ACK:
+        // ACK all bytes but the last one
+        TWCR = (t->len > 1 ? TWCR_ACK : TWCR_NACK);
+        break;
+
+    case TW_MR_DATA_ACK:
+        t->buf[_idx++] = TWDR;
+        TWCR = (_idx+1 < t->len ? TWCR_ACK : TWCR_NACK);
+        break;
+
+    case TW_MR_DATA_NACK:
+        t->buf[_idx++] = TWDR;
+        _finish(TWI_DONE);
+        break;
+
+    default:
+        // SLA or data NACK, arbitration lost, bus error
+        _errors++;
+        _finish(TWI_ERROR);
+        break;
+    }
+}
+
+ISR(TWI_vect)
+{
+    TWIQueue::_isr();
+}
+
+// end TWIQueue.cpp
@@ -0,0 +1,81 @@
+// =======================================================================
+// @file        TWIQueue.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Non-blocking, interrupt-driven I2C (TWI) master for AVR
+//              with a queue of register transactions
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef TWIQUEUE_H
+#define TWIQUEUE_H
+
+#include <Arduino.h>
+
+/// Each transaction addresses a register-based device (like the MCP23017):
+/// - write: START, SLA+W, reg, data[0..len-1], STOP
+/// - read:  START, SLA+W, reg, REPEATED START, SLA+R, data[0..len-1], STOP
+///
+/// Transaction descriptors are owned by the caller and must stay valid (and untouched)
+/// until their status is no longer TWI_PENDING; the same descriptor can then be resubmitted.
+/// Transactions are processed in the order of submission, entirely from the TWI interrupt.
+///
+/// This library takes over the TWI peripheral (and its ISR): it cannot be used together with Wire.
+
+enum : uint8_t {
+    TWI_IDLE = 0,           // Never submitted
+    TWI_PENDING,            // Queued or in progress
+    TWI_DONE,               // Completed successfully
+    TWI_ERROR,              // NACK or bus arbitration lost
+};
+
+struct TWItx {
+    uint8_t             addr;       // 7-bit device address
+    uint8_t             reg;        // Register address (first byte written)
+    uint8_t             *buf;       // Data buffer
+    uint8_t             len;        // Number of data bytes
+    bool                read;       // Read (true) or write (false) transaction
+    volatile uint8_t    status;
+};
+
+class TWIQueue
+{
+    public:
+        static constexpr uint8_t QSIZE = 8;     // Must be a power of 2
+
+        // Setup the TWI peripheral; freq is the SCL frequency (100kHz or 400kHz).
+        static void     begin(uint32_t freq = 400000UL);
+
+        // Queue a transaction. Returns false if the queue is full.
+        static bool     submit(TWItx *t);
+
+        // Fill and queue a transaction
+        static bool     submit(TWItx *t, uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len, bool read);
+
+        // Busy-wait for a transaction to complete. Returns true if successful.
+        static bool     wait(TWItx *t);
+
+        static bool     idle(void)          { return (_head == _tail); }
+        static uint8_t  pending(void)       { return (uint8_t)(_head - _tail); }
+
+        // Statistics
+        static uint16_t getErrors(void)     { return _errors; }
+
+        // Internal: state machine step, called by the TWI ISR
+        static void     _isr(void);
+
+    private:
+        static TWItx*   volatile _queue[QSIZE];
+        static volatile uint8_t  _head;         // Next free entry (written by submit)
+        static volatile uint8_t  _tail;         // Transaction in progress (written by ISR)
+        static uint8_t           _idx;          // Data byte index in current transaction
+        static bool              _regSent;      // Register address sent for current transaction
+        static uint16_t          _errors;
+
+        static void     _start(void);
+        static void     _finish(uint8_t status);
+};
+
+#endif // TWIQUEUE_H
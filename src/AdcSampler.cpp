@@ -0,0 +1,139 @@
+// =======================================================================
+// @file        AdcSampler.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Free-running, interrupt-driven ADC sampler for the analog inputs
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "main.h"
+#include "AdcSampler.h"
+#include <avr/interrupt.h>
+
+uint8_t                     AdcSampler::_ch[MAXCH];
+uint8_t                     AdcSampler::_nCh      = 0;
+uint16_t                    AdcSampler::_mask     = 0;
+uint8_t                     AdcSampler::_idx      = 0;
+int8_t                      AdcSampler::_cnt      = 0;
+uint16_t                    AdcSampler::_acc      = 0;
+uint16_t                    AdcSampler::_buf[2][MAXCH];
+volatile uint8_t            AdcSampler::_wr       = 0;
+volatile uint8_t            AdcSampler::_seq      = 0;
+uint8_t                     AdcSampler::_lastSeq  = 0;
+uint8_t                     AdcSampler::_vals[MAXCH];
+
+void
+AdcSampler::begin(M10board* brds, uint16_t extraChans)
+{
+    end();
+
+    uint16_t chans = extraChans;
+    for(uint8_t s = 0; s < Config::MAX_BOARDS; s++) {
+        if(!isBoardAttached(s)) continue;
+        for(uint8_t n = 0; n < brds[s].nAnaIns(); n++) {
+            chans |= (1 << (brds[s].getAIpin(n) - A0));
+        }
+    }
+    memset(_buf, 0, sizeof(_buf));
+    memset(_vals, 0, sizeof(_vals));
+    _nCh = 0;
+    _mask = chans;
+    for(uint8_t c = 0; c < MAXCH; c++) {
+        if(chans & (1 << c)) _ch[_nCh++] = c;
+    }
+    if(_nCh == 0) return;
+
+    uint8_t sreg = SREG;
+    cli();
+    _idx = 0;
+    _acc = 0;
+    _cnt = -1;
+    _lastSeq = _seq;
+    _select(_ch[0]);
+    // ADC enabled, clk/128 (125kHz @ 16MHz: ~104us per conversion), interrupt on completion
+    ADCSRA = _BV(ADEN) | _BV(ADIE) | _BV(ADIF) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+    ADCSRA |= _BV(ADSC);
+    SREG = sreg;
+}
+
+void
+AdcSampler::end(void)
+{
+    // Let the conversion in progress (if any) complete without triggering the ISR;
+    // ADEN is left on for analogRead()
+    ADCSRA &= ~_BV(ADIE);
+    while(ADCSRA & _BV(ADSC));
+    _nCh = 0;
+    _mask = 0;
+}
+
+void
+AdcSampler::_select(uint8_t ch)
+{
+#ifdef MUX5
+    ADCSRB = (ADCSRB & ~_BV(MUX5)) | ((ch & 0x08) ? _BV(MUX5) : 0);
+#endif
+    // AVcc reference
+    ADMUX = _BV(REFS0) | (ch & 0x07);
+}
+
+uint16_t
+AdcSampler::read(uint8_t ch)
+{
+    uint16_t v;
+    uint8_t  s;
+    if(ch >= MAXCH) return 0;
+    do {
+        s = _seq;
+        v = _buf[_wr ^ 1][ch];
+    } while(s != _seq);
+    return v;
+}
+
+bool
+AdcSampler::process(void)
+{
+    uint8_t s;
+    if(_seq == _lastSeq) return false;
+    do {
+        s = _seq;
+        const uint16_t *b = _buf[_wr ^ 1];
+        for(uint8_t i = 0; i < _nCh; i++) {
+            uint8_t c = _ch[i];
+            _vals[c] = (uint8_t)(b[c] >> 2);
+        }
+    } while(s != _seq);
+    _lastSeq = s;
+    return true;
+}
+
+void
+AdcSampler::_isr(void)
+{
+    uint16_t v = ADC;
+
+    if(_cnt >= 0) _acc += v;
+    if(++_cnt >= OVS) {
+        _buf[_wr][_ch[_idx]] = (_acc + (OVS/2)) >> OVS_SHIFT;
+        _acc = 0;
+        if(++_idx >= _nCh) {
+            // Round complete: publish it
+            _idx = 0;
+            _wr ^= 1;
+            _seq++;
+        }
+        // With a single channel, there is no switching to settle
+        _cnt = (_nCh > 1 ? -1 : 0);
+        _select(_ch[_idx]);
+    }
+    ADCSRA |= _BV(ADSC);
+}
+
+ISR(ADC_vect)
+{
+    AdcSampler::_isr();
+}
+
+// end AdcSampler.cpp
@@ -0,0 +1,87 @@
+// =======================================================================
+// @file        AdcSampler.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Free-running, interrupt-driven ADC sampler for the analog inputs
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef ADCSAMPLER_H
+#define ADCSAMPLER_H
+
+#include <Arduino.h>
+
+class M10board;
+
+/// The ADC interrupt cycles through all the analog channels used by the attached boards
+/// (see M10board::setupAnaIns()): each conversion starts the next one, so the sampling never
+/// waits on the main loop, and the main loop never waits on a conversion (a blocking analogRead()
+/// takes about 110us).
+///
+/// Each channel is sampled OVS times in a row and the samples are averaged (decimated) into a
+/// 10-bit value; when switching channel, one extra conversion is discarded to let the
+/// S/H capacitor settle on high-impedance sources (pots).
+///
+/// Values are written into one of two buffers while the other one holds the last complete round;
+/// buffers are swapped at the end of each round, and a sequence number is incremented.
+/// Readers check the sequence number to detect a swap during their read.
+///
+/// process() (called from the main loop) copies the last round, scaled to 8 bits, into a value
+/// image indexed by channel, which stays stable between calls: this is the image to feed to
+/// ButtonManager::setAnalogSource() (the analog buttons bound to the manager use pin = channel+1).
+///
+/// While the sampler is active, analogRead() must not be used: analog HW buttons should read
+/// through readPin() (see Button::setAnalogReader()).
+
+class AdcSampler
+{
+    public:
+        static constexpr uint8_t MAXCH     = 16;
+        static constexpr uint8_t OVS_SHIFT = 2;
+        static constexpr uint8_t OVS       = (1 << OVS_SHIFT);     // Samples per value
+
+    private:
+        static uint8_t              _ch[MAXCH];     // Channels sampled, in sequence order
+        static uint8_t              _nCh;
+        static uint16_t             _mask;          // Bit mask of the sampled channels
+        static uint8_t              _idx;           // Position in the sequence
+        static int8_t               _cnt;           // Samples taken for the current channel (<0: settling)
+        static uint16_t             _acc;
+        static uint16_t             _buf[2][MAXCH]; // Double buffer (10-bit values, by channel)
+        static volatile uint8_t     _wr;            // Buffer currently written by the ISR
+        static volatile uint8_t     _seq;           // Number of complete rounds
+        static uint8_t              _lastSeq;
+        static uint8_t              _vals[MAXCH];   // 8-bit value image (by channel), updated by process()
+
+        static void     _select(uint8_t ch);
+
+    public:
+        // Collect the analog channels used by the attached boards (plus those in <extraChans>,
+        // e.g. for HW analog buttons), and start the conversions.
+        // To be called after boardSetup().
+        static void     begin(M10board* brds, uint16_t extraChans = 0);
+        static void     end(void);
+        static bool     active(void)        { return (_nCh != 0); }
+        static uint16_t channels(void)      { return _mask; }
+
+        // Number of complete rounds (wraps around)
+        static uint8_t  seq(void)           { return _seq; }
+
+        // Last value (10 bits) of channel <ch> (0..15); 0 if the channel is not sampled
+        static uint16_t read(uint8_t ch);
+
+        // Last value (8 bits) of analog pin <pin> (A0..A15, or channel number like analogRead())
+        static uint8_t  readPin(uint8_t pin)    { return (uint8_t)(read(pin >= A0 ? pin - A0 : pin) >> 2); }
+
+        // Update the 8-bit value image from the last complete round.
+        // Returns true if new values were available since the last call.
+        static bool     process(void);
+        static uint8_t* values(void)        { return _vals; }
+
+        // Internal: called by the ADC ISR
+        static void     _isr(void);
+};
+
+#endif // ADCSAMPLER_H
@@ -0,0 +1,88 @@
+// =======================================================================
+// @file        AnaInputs.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Analog input filtering and change reporting
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "AnaInputs.h"
+
+AnaInputs::Chan             AnaInputs::_ch[AdcSampler::MAXCH];
+uint16_t                    AnaInputs::_valid     = 0;
+uint16_t                    AnaInputs::_pending   = 0;
+uint16_t                    AnaInputs::_fresh     = 0;
+AnaInputs::ANAcallback      AnaInputs::_cb        = nullptr;
+
+void
+AnaInputs::begin(void)
+{
+    for(uint8_t c = 0; c < AdcSampler::MAXCH; c++) {
+        configure(c, DEF_SMOOTH, DEF_DEADBAND, DEF_MININTV);
+    }
+    _valid   = 0;
+    _pending = 0;
+    _fresh   = 0;
+}
+
+void
+AnaInputs::configure(uint8_t ch, uint8_t smooth, uint8_t deadband, uint16_t minIntv)
+{
+    if(ch >= AdcSampler::MAXCH) return;
+    _ch[ch].smooth   = (smooth > FRAC ? FRAC : smooth);
+    _ch[ch].deadband = deadband;
+    _ch[ch].minIntv  = minIntv;
+}
+
+void
+AnaInputs::update(void)
+{
+    uint16_t chans = AdcSampler::channels();
+    uint16_t msk = 0x0001;
+    for(uint8_t c = 0; c < AdcSampler::MAXCH; c++, msk <<= 1) {
+        if((chans & msk) == 0) continue;
+        Chan &ch = _ch[c];
+        uint16_t v = AdcSampler::read(c) << FRAC;
+        if((_valid & msk) == 0) {
+            // First value: no history to smooth with; reported right away
+            ch.ema = v;
+            _valid   |= msk;
+            _pending |= msk;
+            _fresh   |= msk;
+            continue;
+        }
+        ch.ema = (uint16_t)((int32_t)ch.ema + (((int32_t)v - (int32_t)ch.ema) >> ch.smooth));
+
+        uint16_t f = read(c);
+        uint16_t d = (f > ch.sent ? f - ch.sent : ch.sent - f);
+        if(d > ch.deadband || (d != 0 && (f == 0 || f == VMAX))) {
+            _pending |= msk;
+        }
+    }
+}
+
+bool
+AnaInputs::report(uint16_t now)
+{
+    uint8_t  n = 0;
+    uint16_t msk = 0x0001;
+    if(_pending == 0) return false;
+    for(uint8_t c = 0; c < AdcSampler::MAXCH; c++, msk <<= 1) {
+        if((_pending & msk) == 0) continue;
+        Chan &ch = _ch[c];
+        // Not due yet: the latest value will be sent when the interval expires
+        if(!(_fresh & msk) && (uint16_t)(now - ch.stamp) < ch.minIntv) continue;
+        if(n >= MAXBATCH) return true;
+        _pending &= ~msk;
+        _fresh   &= ~msk;
+        ch.sent  = read(c);
+        ch.stamp = now;
+        if(_cb) _cb(c, ch.sent);
+        n++;
+    }
+    return false;
+}
+
+// end AnaInputs.cpp
@@ -0,0 +1,79 @@
+// =======================================================================
+// @file        AnaInputs.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Analog input filtering and change reporting
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef ANAINPUTS_H
+#define ANAINPUTS_H
+
+#include <Arduino.h>
+#include "AdcSampler.h"
+
+/// Per-channel processing of the values sampled by the AdcSampler, before they are reported
+/// to the host:
+/// - smoothing: exponential moving average (the weight of each new round is 1/2^smooth);
+/// - deadband: a change is only reported if the filtered value moved more than 'deadband' ADC units
+///   from the last reported value (the ends of the range are always reported, so they can be reached);
+/// - rate limiting: a channel is reported at most once every 'minIntv' ms; changes occurring in
+///   the meantime are coalesced, and the latest value is sent when the interval expires.
+///
+/// update() runs the filters on each new sampler round; report() sends the pending changes which
+/// are due, all in the same pass (up to MAXBATCH per call), through the callback.
+/// All values are 10-bit (0..1023).
+
+class AnaInputs
+{
+    public:
+        // Change callback: channel (0..15 for A0..A15), new filtered value
+        using ANAcallback = void (*)(uint8_t ch, uint16_t value);
+
+        static constexpr uint8_t    DEF_SMOOTH   = 2;
+        static constexpr uint8_t    DEF_DEADBAND = 4;
+        static constexpr uint16_t   DEF_MININTV  = 50;
+        static constexpr uint8_t    MAXBATCH     = 4;
+
+    private:
+        static constexpr uint8_t    FRAC = 6;               // Fractional bits of the EMA (10+6 bits)
+        static constexpr uint16_t   VMAX = 1023;
+
+        struct Chan {
+            uint16_t    ema;            // Filtered value, <<FRAC
+            uint16_t    sent;           // Last reported value
+            uint16_t    stamp;          // Time of the last report (ms)
+            uint16_t    minIntv;
+            uint8_t     smooth;
+            uint8_t     deadband;
+        };
+
+        static Chan         _ch[AdcSampler::MAXCH];
+        static uint16_t     _valid;     // Channels with a filtered value
+        static uint16_t     _pending;   // Channels with a change to report
+        static uint16_t     _fresh;     // Channels whose first value is yet to be reported
+        static ANAcallback  _cb;
+
+    public:
+        // Reset all channels to the default settings; to be called after AdcSampler::begin()
+        static void     begin(void);
+        static void     setCallback(ANAcallback cb)     { _cb = cb; }
+        static void     configure(uint8_t ch, uint8_t smooth, uint8_t deadband, uint16_t minIntv);
+
+        // Filtered value (10 bits) of channel <ch>
+        static uint16_t read(uint8_t ch)    { return (ch < AdcSampler::MAXCH ? (uint16_t)((_ch[ch].ema + (1 << (FRAC-1))) >> FRAC) : 0); }
+        // Filtered value (8 bits) of analog pin <pin> (A0..A15, or channel number like analogRead())
+        static uint8_t  readPin(uint8_t pin)    { return (uint8_t)(read(pin >= A0 ? pin - A0 : pin) >> 2); }
+
+        // Feed the filters with the last sampler round, and flag the channels whose change
+        // exceeds their deadband
+        static void     update(void);
+
+        // Send the flagged changes which are due.
+        // Returns true if due changes are left for the next call (batch limit reached).
+        static bool     report(uint16_t now);
+};
+
+#endif // ANAINPUTS_H
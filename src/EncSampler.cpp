@@ -0,0 +1,128 @@
+// =======================================================================
+// @file        EncSampler.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Fixed-rate (1ms) encoder line sampler, driven by the Timer2 interrupt
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "main.h"
+#include "EncSampler.h"
+#include <avr/interrupt.h>
+
+M10board*                   EncSampler::boards    = nullptr;
+uint16_t                    EncSampler::slots     = 0;
+volatile uint16_t           EncSampler::_tick     = 0;
+uint16_t                    EncSampler::_lastTick = 0;
+uint16_t                    EncSampler::_retry    = 0;
+uint32_t                    EncSampler::_last[Config::MAX_BOARDS];
+SPSCRing<EncSample, EncSampler::QSIZE>  EncSampler::_queue;
+
+void
+EncSampler::begin(M10board* brds)
+{
+    boards = brds;
+    slots  = 0;
+    for(uint8_t s = 0; s < Config::MAX_BOARDS; s++) {
+        if(isBoardAttached(s) && boards[s].configured() && boards[s].hasEncoders()) slots |= (1<<s);
+    }
+    if(slots == 0) return;
+
+    // Initial sample of all boards
+    for(uint8_t s = 0; s < Config::MAX_BOARDS; s++) {
+        if(slots & (1<<s)) {
+            boards[s].sampleEncLines(_last[s], true);
+            _queue.push(EncSample{_last[s], _tick, s});
+        }
+    }
+    _lastTick = _tick;
+    _retry = 0;
+
+    uint8_t sreg = SREG;
+    cli();
+    // Timer2 in CTC mode, clk/64, 1ms period
+    TCCR2A = _BV(WGM21);
+    TCCR2B = _BV(CS22);
+    OCR2A  = (uint8_t)((F_CPU / 64 / 1000) - 1);
+    TCNT2  = 0;
+    TIFR2  = _BV(OCF2A);
+    TIMSK2 = _BV(OCIE2A);
+    SREG = sreg;
+}
+
+void
+EncSampler::end(void)
+{
+    TIMSK2 &= ~_BV(OCIE2A);
+    slots = 0;
+}
+
+uint16_t
+EncSampler::tick(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t t = _tick;
+    SREG = sreg;
+    return t;
+}
+
+void
+EncSampler::poll(void)
+{
+    if(slots == 0) return;
+    uint16_t t = tick();
+    if(t == _lastTick) return;
+    _lastTick = t;
+    _sample(t);
+}
+
+void
+EncSampler::_sample(uint16_t tick)
+{
+    uint16_t msk = 0x0001;
+    uint32_t v;
+    for(uint8_t s = 0; s < Config::MAX_BOARDS; s++, msk <<= 1) {
+        if((slots & msk) == 0) continue;
+        // A change not queued yet must be read again even if no longer signalled (notify mode)
+        if(!boards[s].sampleEncLines(v, (_retry & msk) != 0)) continue;
+        // Only changes are queued; if the queue is full, the change will be retried at the next tick
+        if(v == _last[s] || _queue.push(EncSample{v, tick, s})) {
+            _last[s] = v;
+            _retry &= ~msk;
+        } else {
+            _retry |= msk;
+        }
+    }
+}
+
+void
+EncSampler::process(void)
+{
+    EncSample smp;
+    while(_queue.pop(smp)) {
+        boards[smp.slot].ProcessEncoders(smp.vec, smp.tick);
+    }
+
+    // Samples queued after this point are newer than 'now'
+    uint8_t sreg = SREG;
+    cli();
+    bool idle = _queue.empty();
+    uint16_t now = _tick;
+    SREG = sreg;
+    if(!idle) return;
+
+    uint16_t msk = 0x0001;
+    for(uint8_t s = 0; s < Config::MAX_BOARDS; s++, msk <<= 1) {
+        if(slots & msk) boards[s].ProcessEncoders(boards[s].encLines(), now);
+    }
+}
+
+ISR(TIMER2_COMPA_vect)
+{
+    EncSampler::_isr();
+}
+
+// end EncSampler.cpp
@@ -0,0 +1,78 @@
+// =======================================================================
+// @file        EncSampler.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Fixed-rate (1ms) encoder line sampler, driven by the Timer2 interrupt
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef ENCSAMPLER_H
+#define ENCSAMPLER_H
+
+#include <Arduino.h>
+#include "M10board.h"
+#include "spscRing.h"
+
+/// The Timer2 ISR keeps a 1ms clock, and flags a sample as due at every tick; the SPI reads are never
+/// done in interrupt context. poll(), called from the main loop as often as possible, reads the encoder
+/// lines of all attached boards with encoders directly from their expanders when a sample is due,
+/// and pushes every changed sample, with the board slot and the sampling time, into a SPSC ring buffer;
+/// the encoder task drains the buffer with process(), feeding each board's encoder processor with
+/// timestamped samples.
+///
+/// Boards in change-notification mode are only read when their IRQ line signals a change; since reading
+/// the expander GPIO registers clears the notification, they then get a full input read at their next
+/// scan (see M10board::sampleEncLines()).
+
+struct EncSample {
+    uint32_t    vec;        // Raw encoder lines (see M10board::ProcessEncoders())
+    uint16_t    tick;       // Sampling time (ms)
+    uint8_t     slot;
+};
+
+class EncSampler
+{
+    public:
+        static constexpr uint8_t QSIZE = 16;    // Must be a power of 2
+
+    private:
+        static M10board*            boards;
+        static uint16_t             slots;      // Bit mask of sampled slots
+        static volatile uint16_t    _tick;      // Free-running ms counter
+        static uint16_t             _lastTick;  // Time of the last sample taken by poll()
+        static uint16_t             _retry;     // Slots with a changed sample which could not be queued
+        static uint32_t             _last[Config::MAX_BOARDS];
+        static SPSCRing<EncSample, QSIZE>   _queue;
+
+        static void     _sample(uint16_t tick);
+
+    public:
+        // Collect the attached boards with encoders and start the 1ms timer interrupt.
+        // To be called after boardSetup().
+        static void     begin(M10board* brds);
+        static void     end(void);
+        static bool     active(void)        { return (slots != 0); }
+
+        // Current time (ms) of the sampler clock
+        static uint16_t tick(void);
+
+        // Take a sample of the encoder lines, if due (i.e. at most once per tick).
+        // To be called from the main loop, outside of any SPI bus session.
+        static void     poll(void);
+
+        // Drain the sample queue, feeding the boards' encoder processors;
+        // when no new samples are available, the encoder processors are fed anyway with the current
+        // lines and time (debounce and long press are timed there).
+        static void     process(void);
+
+        // Statistics
+        static uint16_t getOverflows(void)  { return _queue.overflows(); }
+        static uint8_t  getHighWater(void)  { return _queue.highWater(); }
+
+        // Internal: called by the Timer2 ISR
+        static void     _isr(void)          { _tick++; }
+};
+
+#endif // ENCSAMPLER_H
@@ -23,6 +23,24 @@ M10board::M10board(void* memAllocator(uint16_t))
     nAINS = 0;
 }
 
+void
+M10board::setSlot(uint8_t slot)
+{
+    if(slot >= Config::MAX_BOARDS) return;
+    pins.PX_SS  = PX_SSn[slot];
+    pins.PX_IRQ = PX_IRQn[slot];
+    pins.LD_CSA = LD_CSAn[slot];
+    pins.LD_CSB = LD_CSBn[slot];
+    pins.LCD_EN = (slot < sizeof(LCD_ENn) ? LCD_ENn[slot] : -1);
+    Din.bind(InImage.slot(slot));
+    Config::getCtlSet(slot, ctl);
+    BtnMgr.setTable(ctl.btns, ctl.nBtns);
+    // Analog buttons read the values published by the ADC sampler
+    BtnMgr.setAnalogSource(AdcSampler::values(), AdcSampler::MAXCH);
+    // IRQ lines from the expanders are open-drain
+    pinMode(pins.PX_IRQ, INPUT_PULLUP);
+}
+
 void
 M10board::setupAnaIns(uint16_t ai)
 {
@@ -51,36 +69,36 @@ M10board::setupAnaIns(uint16_t ai)
 }
 
 void
-M10board::setBoardCfg(M10BoardConfig *c)
+M10board::setBoardCfg(const M10BoardConfig *c)
 {
-    //! TODO - WARNING: <c> is in PROGMEM! Either:
-    //  - change cfg from pointer to var (uses RAM)
-    //  - move BoardCfg[] out of PROGMEM (uses RAM)
-    //  - assign "cfg = F(c)" rather than "cfg = c" (or whatever corrects to progmem reference)
-    
-    //memcpy(&cfg, c, sizeof(M10BoardConfig));
-    cfg = c;
+    // <c> is in PROGMEM: work on a copy
+    memcpy_P(&cfgData, c, sizeof(M10BoardConfig));
+    cfg = &cfgData;
 
-    // MCPIO1 = &_MCPIO1;  // TEST!!! TO BE REMOVED
-    MCPIO1 = new (memAlloc(sizeof(MCPS))) MCPS(0,10);
+    // Both expanders of the board share the slot SEL line, and are told apart by their HW address
+    MCPIO1 = new (memAlloc(sizeof(MCPS))) MCPS(0, pins.PX_SS);
     MCPIO1->begin();
-    MCPIO1->inputInvert(0xFFFF);
-    setIOMode(0,~cfg->digOutputs);
-    setPUMode(0,~cfg->digOutputs);
+    // Mode, pull-ups and inversion in a single burst
+    IOcfg[0] = IOpullup[0] = ~cfg->digOutputs;
+    MCPIO1->configure(IOcfg[0], IOpullup[0], 0xFFFF);
 
     if(cfg->hasBank2) {
-        // MCPIO2 = &_MCPIO2;  // TEST!!! TO BE REMOVED
-        MCPIO2 = new (memAlloc(sizeof(MCPS))) MCPS(0,15);   // PCB v1.0
-        //MCPIO2 = new (memAlloc(sizeof(MCPS))) MCPS(1,10);   // PCB v1.1
+        MCPIO2 = new (memAlloc(sizeof(MCPS))) MCPS(1, pins.PX_SS);
         MCPIO2->begin();
-        MCPIO2->inputInvert(0xFFFF);
-        setIOMode(1,~cfg->digOutputs2);
-        setPUMode(1,~cfg->digOutputs2);
+        IOcfg[1] = IOpullup[1] = ~cfg->digOutputs2;
+        MCPIO2->configure(IOcfg[1], IOpullup[1], 0xFFFF);
     }
 
     setupAnaIns(cfg->anaInputs);
 
+    // Inputs read on change notification only (needs the expanders configured above)
+    setInputNotify(cfg->inNotify);
+
     Encs.init(cfg->nEncoders > 8 ? 8 : cfg->nEncoders);      // Correct actual numbers of used encoders (max 8)
+    // Acceleration profiles from the board definition (one nibble per encoder)
+    for(uint8_t i=0; i < cfg->nEncoders && i < 8; i++) {
+        Encs.setAccel(i+1, (uint8_t)((cfg->encAccel >> (4*i)) & 0x0F));
+    }
 
 if(cfg->hasDisplays) {
     LedControl* base = (LedControl*)_DISP;
@@ -109,7 +127,14 @@ M10board::setBoardPostCfg(void)
     uint8_t ne = (cfg->nVirtEncoders==0 ? cfg->nEncoders : cfg->nVirtEncoders);
     for(uint8_t i=0; i < ne; i++) {
         // Get number of configured modes from ManagedEnc into ENCS
-        Encs.setNModes(i+1, EncMgr.getEnc(i+1)->getNModes());
+        ManagedEnc *ep = EncMgr.get(i+1);
+        if(ep != nullptr) Encs.setNModes(i+1, ep->getNModes());
+    }
+    // Encoders described in the board definition take their number of modes from there
+    for(uint8_t r = 0; r < ctl.nEncs; r++) {
+        EncDesc d;
+        CtlTable::read(&ctl.encs[r], d);
+        Encs.setNModes(d.enc, d.nModes);
     }
     if(cfg->hasDisplays) {
         if(cfg->nDisplays1) {
@@ -136,6 +161,7 @@ void M10board::setIOMode(uint8_t bank, uint16_t IOmode)
     } else if( cfg->hasBank2) {
         MCPIO2->pinMode(IOcfg[1] = IOmode); 
     } 
+    if(inNotify) setInputNotify(true);
 }            
 
 void M10board::setPUMode(uint8_t bank, uint16_t PUmode)
@@ -170,8 +196,11 @@ M10board::setIOPinMode(uint8_t pin, uint8_t mode)
     } else {
         IOcfg[bank] &= ~(1<<pin);
     }
+    MCPIO->defer(true);
     MCPIO->pinMode(IOcfg[bank]);
     MCPIO->pullupMode(IOpullup[bank]);
+    if(inNotify) setInputNotify(true);
+    MCPIO->defer(deferred);
 }
 
 void
@@ -183,8 +212,11 @@ M10board::setIOMode(uint8_t bank, uint16_t dir, uint16_t pullups)
     MCP *MCPIO = (bank == 0) ? MCPIO1 : MCPIO2;
     IOcfg[bank] = dir;
     IOpullup[bank] = pullups;
+    MCPIO->defer(true);
     MCPIO->pinMode(IOcfg[bank]);
     MCPIO->pullupMode(IOpullup[bank]);
+    if(inNotify) setInputNotify(true);
+    MCPIO->defer(deferred);
 }
 
 void
@@ -197,17 +229,24 @@ M10board::outWrite(uint8_t pin, uint8_t val)
         if(bank == 1 && !cfg->hasBank2) return;
         cacheWrite(pin+1, val);
         MCP *MCPIO = (pin<16) ? MCPIO1 : MCPIO2;
-        MCPIO->IOWrite((pin & 0x0F), val);
+        MCPIO->IOWrite((pin & 0x0F)+1, val);
+        Dout.chgClr(pin+1);     // Already written: no need to commit again
     } else {
         // These are not cached
         pin &= 0x1F; // pin -= 32;
         if((pin >= cfg->nLEDsOnMAX) || cfg->LEDsOnMAX == nullptr) return;
         LEDonMAX led = cfg->LEDsOnMAX[pin];
-        // TODO ......
-        // MAX.setSegment(led.unit, led.digit, led.segment, val);
+        segWrite(led.unit, led.digit, led.segment, val);
     }
 }
 
+void
+M10board::segWrite(uint8_t unit, uint8_t digit, uint8_t seg, uint8_t val)
+{
+    if(!cfg->hasDisplays) return;
+    LEDCTRL[(unit>>1)&0x01].setLed(unit&0x01, digit, seg, (val != 0));
+}
+
 void
 M10board::cacheWrite(uint8_t pin, uint8_t val)
 {
@@ -271,26 +310,99 @@ M10board::remapEncoder(byte fromPos, byte toPos)
 }
 
 void
-M10board::ScanInOut(byte mode)
+M10board::setInputNotify(bool on)
+{
+    if(pins.PX_IRQ < 0) on = false;
+    inNotify = on;
+    // Interrupt on change (against previous state) on all input pins;
+    // both ports OR'ed on the same line, open-drain since both chips share it
+    MCPIO1->defer(true);
+    MCPIO1->setupInterrupts(1, 1, 0);
+    MCPIO1->interruptMode(on ? IOcfg[0] : 0x0000);
+    MCPIO1->defer(deferred);
+    if(cfg->hasBank2) {
+        MCPIO2->defer(true);
+        MCPIO2->setupInterrupts(1, 1, 0);
+        MCPIO2->interruptMode(on ? IOcfg[1] : 0x0000);
+        MCPIO2->defer(deferred);
+    }
+}
+
+void
+M10board::deferConfig(bool on)
+{
+    deferred = on;
+    MCPIO1->defer(on);
+    if(cfg->hasBank2) MCPIO2->defer(on);
+}
+
+void
+M10board::ScanInOut(byte mode, bool force)
 {
     uint16_t    iovec;
+    uint16_t    intf;
+    uint16_t    pulse;
+    unsigned int icap;
+    unsigned int gpio;
     // uint32_t    encvec;
 
     // ==============================
     //  Write Digital Outputs
     // ==============================
     if(mode != 1) {
-        iovec = Dout.valW(0);  //Dout.val()[0] + (Dout.val()[1] << 8);
-        MCPIO1->IOWrite(iovec);   // Pins configured as input are ignored on write
+        if(force || Dout.chgW(0)) {
+            iovec = Dout.valW(0);  //Dout.val()[0] + (Dout.val()[1] << 8);
+            if(force) MCPIO1->invalidate();     // Rewrite the whole register file, not just the outputs
+            MCPIO1->IOWrite(iovec);   // Pins configured as input are ignored on write
+            Dout.chgClrW(0);
+            outWrites++;
+        } else {
+            outSkips++;
+        }
         if(cfg->hasBank2) {
-            iovec = Dout.valW(2);  //Dout.val()[2] + (Dout.val()[3] << 8);
-            MCPIO2->IOWrite(iovec);   // Pins configured as input are ignored on write
+            if(force || Dout.chgW(2)) {
+                iovec = Dout.valW(2);  //Dout.val()[2] + (Dout.val()[3] << 8);
+                if(force) MCPIO2->invalidate();
+                MCPIO2->IOWrite(iovec);   // Pins configured as input are ignored on write
+                Dout.chgClrW(2);
+                outWrites++;
+            } else {
+                outSkips++;
+            }
         }
     }
     // ==============================
     //  Read Digital Inputs
     // ==============================
     if(mode != 2) {
+        if(inResync) {
+            inResync = false;
+            force = true;
+        }
+        if(inNotify && !force) {
+            // IRQ line is active LOW: if idle, no input has changed since last read
+            if(digitalRead(pins.PX_IRQ) == HIGH) return;
+
+            // INTF, INTCAP and GPIO are fetched in a single burst (reading INTCAP clears the IRQ).
+            // Inputs take their current level from GPIO. A pin flagged in INTF whose captured value
+            // differs from GPIO has pulsed since the capture: the captured value is reported for this
+            // scan, so that short pulses are not lost, and the next scan is a full read.
+            intf  = MCPIO1->getIntState(icap, gpio);
+            pulse = intf & (icap ^ gpio) & IOcfg[0];
+            iovec = ((gpio & ~pulse) | (icap & pulse)) & IOcfg[0];
+            Din.writeW(0, iovec);
+            if(cfg->hasBank2) {
+                intf  = MCPIO2->getIntState(icap, gpio);
+                intf &= (icap ^ gpio) & IOcfg[1];
+                iovec = ((gpio & ~intf) | (icap & intf)) & IOcfg[1];
+                Din.writeW(2, iovec);
+                pulse |= intf;
+            }
+            if(pulse) inResync = true;
+            return;
+        }
+
+        // Full read (also clears any pending IRQ)
         iovec = MCPIO1->IORead() & IOcfg[0];
         Din.writeW(0, iovec);
 
@@ -308,23 +420,60 @@ M10board::ProcessSwitches(void)
 {
     //  Handle button/switch processing
     // ===================================
-    ButtonMgr.checkButtons(Din.val());
+    uint8_t *in = Din.val();
+    if(cfg->swFilter == SWF_VCOUNT) in = Deb.update(in);
+    BtnMgr.checkButtons(in);
+}
+
+bool
+M10board::switchesBusy(void)
+{
+    return (cfg->swFilter == SWF_VCOUNT) || BtnMgr.busy();
 }
 
 void
 M10board::ProcessEncoders(void)
 {
-    if(cfg->nEncoders + cfg->nVirtEncoders == 0) return;
+    uint32_t raw = 0;
     
-    //  Handle encoder input mirroring
-    // ===================================
     // collect physical enc inputs
     if(cfg->nEncoders > 3) {
         // assert(cfg->nVirtEncoders == 0); // Virtual encoders only available if no 2nd bank is used!
-        encInputs = (Din.valW(2) & 0x01FF);    // Encoders 4..6 (2nd bank)
-        encInputs <<= 9;
+        raw = (Din.valW(2) & 0x01FF);       // Encoders 4..6 (2nd bank)
+        raw <<= 9;
+    }
+    raw |= (Din.valW(0) & 0x01FF);          // Encoders 1..3 (1st bank)
+    ProcessEncoders(raw, FrameClock::now16());
+}
+
+bool
+M10board::sampleEncLines(uint32_t &raw, bool force)
+{
+    if(inNotify) {
+        // No change signalled since the last read: nothing to do
+        if(!force && digitalRead(pins.PX_IRQ) != LOW) return false;
+        // Reading GPIO clears the pending change notification, which the input scan would then miss
+        inResync = true;
     }
-    encInputs |= (Din.valW(0) & 0x01FF);   // Encoders 1..3 (1st bank)
+    raw = 0;
+    if(cfg->nEncoders > 3) {
+        raw = (MCPIO2->IORead() & 0x01FF);  // Encoders 4..6 (2nd bank)
+        raw <<= 9;
+    }
+    raw |= (MCPIO1->IORead() & 0x01FF);     // Encoders 1..3 (1st bank)
+    return true;
+}
+
+void
+M10board::ProcessEncoders(uint32_t raw, uint16_t tick)
+{
+    if(cfg->nEncoders + cfg->nVirtEncoders == 0) return;
+    
+    encRaw = raw;
+
+    //  Handle encoder input mirroring
+    // ===================================
+    encInputs = raw;
 
     if(cfg->nVirtEncoders!=0) {
         // remap encoders if required (ineffective otherwise)
@@ -336,7 +485,7 @@ M10board::ProcessEncoders(void)
     //  Handle encoder input processing
     // ===================================
 
-    Encs.update(encInputs);     // Feed inputs to encoder processors
+    Encs.update(encInputs, tick);   // Feed inputs to encoder processors
     
     // Detect encoders transitions/counts
     // Since the version of EncManager with no callbacks is used, copy relevant data to local vars and pass those along
@@ -356,6 +505,14 @@ M10board::ProcessEncoders(void)
     EncMgr.checkEncs(EncCount, EncModes);
     // If required, also register transitions
     EncMgr.checkEncs(Encs.getEncChangeUp(), Encs.getEncChangeDn(), Encs.getEncChangeQUp(), Encs.getEncChangeQDn(), EncModes);
+    // Encoders described in the board definition
+    if(ctl.nEncs) {
+        EncMgr.checkTable(ctl.encs, (ctl.nEncs > ENCSLOTS ? ENCSLOTS : ctl.nEncs),
+                          Encs.getEncChangeUp(), Encs.getEncChangeDn(), Encs.getEncChangeQUp(), Encs.getEncChangeQDn(),
+                          EncCount, EncModes, ENCSLOTS, EncLastModes);
+    }
+    // Transition flags are only ever set by the encoder processor: consumed, they must be cleared here
+    Encs.clearTrans();
 
     // Manage encoder switch lines
     // (done as ordinary switches - nothing to do here)
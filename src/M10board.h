@@ -27,17 +27,21 @@
 // Board I/O configuration
 //================================
 #include "boardDefine.h"
+#include "ctlTables.h"
 #include "M10board_pins.h"
 
 #include "bitmasks.h"
 #include "conversions.h"
 #include "bank.h"
+#include "ioImage.h"
 #include "FastArduino.h"
 #include "MCP23S17.h"
 #include "Button_all.h"
 #include "EncoderSet.h"
 #include "ButtonManager.h"
+#include "vdebouncer.h"
 #include "EncManager.h"
+#include "AnaInputs.h"
 
 #include "LedControlMod.h"
 #include "LiquidCrystal.h"
@@ -50,6 +54,13 @@ constexpr uint8_t DIN_COUNT  = 64;
 // we have no interest in caching them, so we cam spare some memory
 constexpr uint8_t DOUT_COUNT = 32;  
 
+// Global input image: one 64-bit slice per board slot
+using InputImage = IOImage<Config::MAX_BOARDS, DIN_COUNT>;
+extern InputImage   InImage;
+
+// Encoder objects are shared by all boards (see main.cpp)
+extern EncManager<MAX_TOT_ENCS> EncMgr;
+
 class M10board
 {
 
@@ -67,7 +78,8 @@ class M10board
 
         // ******* Configuration
 
-        M10BoardConfig*    cfg;
+        M10BoardConfig*    cfg = nullptr;  // nullptr until setBoardCfg() (points to cfgData)
+        M10BoardConfig     cfgData;        // RAM copy of the board type configuration
 
         // ******* Control pins
 
@@ -81,18 +93,30 @@ class M10board
 
         // ******* Internal data storage:
 
-        Bank<DIN_COUNT>     Din;            // Buffer for I/O vector - Inputs
-        Bank<DOUT_COUNT>    Dout;           // Buffer for I/O vector - Outputs
+        BankV<DIN_COUNT>    Din;            // Buffer for I/O vector - Inputs (slice of the global image InImage, bound by setSlot())
+        BankC<DOUT_COUNT>   Dout;           // Buffer for I/O vector - Outputs (with change tracking)
+        vdebouncer<DIN_COUNT> Deb;          // Input filter (only used if cfg->swFilter == SWF_VCOUNT)
+
+        uint16_t        outWrites = 0;      // Output words written to the expanders by ScanInOut()
+        uint16_t        outSkips  = 0;      // Output words skipped by ScanInOut() because unchanged
 
         uint16_t        IOcfg[BYTESIZE(DIN_COUNT)];     // In (1) or Out (0)
         uint16_t        IOpullup[BYTESIZE(DIN_COUNT)];  // On (1) or Off (0)
 
+        bool            inNotify = false;   // Inputs are read only upon change notification (IRQ line)
+        bool            inResync = false;   // IRQ cleared by the encoder sampler: next input scan must be a full read
+        bool            deferred = false;   // Expander configuration writes are held until deferConfig(false)
+
         uint8_t*        AINS = nullptr;     // Table array of used analog input pins
         uint8_t         nAINS = 0;          // Number of used analog inputs
 
         // ******* Buttons / Switches
     
-        //ButtonManager   ButtonMgr;  // Use global object
+        // Own manager for the inputs of the board: timing state and flags are kept per board,
+        // and both the table rows and button objects refer to the bits of Din (1-based pins).
+        ButtonManager<DIN_COUNT, BMword, MAXBUTTONS>  BtnMgr;
+
+        Config::CtlSet  ctl = {nullptr, 0, nullptr, 0};     // Control descriptor tables of the slot (bound by setSlot())
 
         // ******* Encoders
     
@@ -100,8 +124,10 @@ class M10board
         EncoderSet      Encs;
         int             EncCount[ENCSLOTS];
         uint8_t         EncModes[ENCSLOTS];
+        uint8_t         EncLastModes[ENCSLOTS] = {0};   // Modes last signalled for the encoder descriptors
         byte            EncMap[3] = {0xFF, 0xFF, 0xFF};  // Encoder mappings; handles only up to 3 source encoders to spare memory
         uint32_t        encInputs;     // Input vector directly read for encoders
+        uint32_t        encRaw = 0;    // Raw encoder lines last processed
         //uint16_t      encSwitches;       // Switches are read directly from I/O lines, not through M10Encoder
         
         //EncManager   EncMgr;  // Use global object
@@ -137,12 +163,24 @@ class M10board
 
         void    init(void) {};
 
-        void    setBoardCfg(M10BoardConfig *cfg);
+        // Assign the board to a hub slot (0..11): sets up the control pins for that slot
+        // and binds the input buffer to the slot's slice of the global input image
+        void    setSlot(uint8_t slot);
+
+        // Apply the configuration of the board type (<c> is an entry of Config::BoardCfg[], in PROGMEM);
+        // requires setSlot() to have been called before
+        void    setBoardCfg(const M10BoardConfig *c);
+        bool    configured(void)    { return (cfg != nullptr); }
         void    setBoardPostCfg(void);
 
         void    setIOMode(uint8_t bank, uint16_t IOmode);   // Mode 0 = Out, 1 = In
         void    setPUMode(uint8_t bank, uint16_t PUmode);   // PullUp: 1 = On
 
+        // While on, I/O configuration changes only update the expander shadow registers;
+        // they are written (merged) to the expanders when turned off.
+        // Useful when configuring the board pin by pin.
+        void    deferConfig(bool on);
+
 
         /// ====================================================
         /// Digital I/O management
@@ -151,7 +189,28 @@ class M10board
         // R/W functions operate on buffers 'Din'/'Dout', therefore require the invocation of ScanInOut(),
         // either before (for inputs) or after (for outputs).
 
-        void        ScanInOut(byte mode=0);   // Mode: 0=R+W, 1=R, 2=W
+        // Mode: 0=R+W, 1=R, 2=W
+        // Outputs are only written to the expanders if any of their bits has changed since the last write.
+        // 'force' requests a full write of the outputs and (in change-notification mode)
+        // a full read of the inputs regardless of the IRQ line, for periodic re-sync.
+        void        ScanInOut(byte mode=0, bool force=false);
+
+        // Output write statistics (words written / skipped by ScanInOut())
+        uint16_t    getOutWrites(void)  { return outWrites; }
+        uint16_t    getOutSkips(void)   { return outSkips;  }
+        void        clearOutStats(void) { outWrites = outSkips = 0; }
+
+        // Change-notification input mode: the expanders signal input changes on the slot IRQ line
+        // (open-drain, active LOW, both ports and both chips OR'ed); ScanInOut() then only reads
+        // the inputs (INTF, INTCAP and GPIO in one burst) when a change has been signalled.
+        // Requires setSlot() and setBoardCfg() to have been called before.
+        void        setInputNotify(bool on);
+        bool        inputNotify(void)   { return inNotify; }
+
+        // Scan rate dividers declared by the board config:
+        // inputs/outputs are refreshed every n-th scan frame (see ScanScheduler)
+        uint8_t     inScanDiv(void)     { return cfg->inScanDiv;  }
+        uint8_t     outScanDiv(void)    { return cfg->outScanDiv; }
 
         // In the functions below, pin = 1..32
         
@@ -173,6 +232,10 @@ class M10board
         // (Obviously also updates cache)
         void        outWrite(uint8_t pin, uint8_t val);
 
+        // Immediate write of a single MAX7219 segment used as a LED.
+        // unit = 0..3 (units 0,1 on display line 1, units 2,3 on display line 2)
+        void        segWrite(uint8_t unit, uint8_t digit, uint8_t seg, uint8_t val);
+
         // FOR DEBUG ONLY (no boundary checks)
         uint16_t    getIns(byte bank = 0)               { return (bank==0 ? MCPIO1->IORead() : MCPIO2->IORead()); }
         void        setOuts(uint16_t ov, byte bank = 0) { (bank==0 ? MCPIO1->IOWrite(ov) : MCPIO2->IOWrite(ov)); }
@@ -182,15 +245,23 @@ class M10board
         /// ====================================================
 
         void        setupAnaIns(uint16_t AIvector);
-        // Read n-th configured analog input (scaled to 0..255)
-        uint8_t     readAI(uint8_t n)   { return ( n < nAINS ? ((analogRead(AINS[n])+2) >> 2) : 0);  }
+        uint8_t     nAnaIns(void)           { return nAINS; }
+        uint8_t     getAIpin(uint8_t n)     { return AINS[n]; }
+        // Read n-th configured analog input (scaled to 0..255);
+        // the filtered value is used if the ADC sampler is running, otherwise the input is read directly (blocking)
+        uint8_t     readAI(uint8_t n)   { return ( n < nAINS ? (AdcSampler::active() ? AnaInputs::readPin(AINS[n]) : (analogRead(AINS[n]) >> 2)) : 0);  }
 
         /// ====================================================
         /// Switch/button management
         /// ====================================================
 
+        // Add a button object to the board (its pin is the 1-based bit of the board inputs)
+        Button  *addButton(Button *bp)  { return BtnMgr.add(bp); }
         // After a fresh input scan, process switches and buttons
         void    ProcessSwitches(void);
+        // True if ProcessSwitches() is required at every frame, even with unchanged inputs
+        // (input filter counting samples, or inputs being timed)
+        bool    switchesBusy(void);
 
         /// ====================================================
         /// Encoder management
@@ -248,9 +319,23 @@ class M10board
         // toPos   = 1..10
         void    remapEncoder(byte fromPos, byte toPos);
         
-        // After a fresh input scan, process encoder inputs
+        // After a fresh input scan, process encoder inputs (taken from the input buffer)
         void    ProcessEncoders(void);
 
+        // Process encoder inputs sampled elsewhere (see EncSampler):
+        // 'raw' holds the encoder lines (bits 0..8 = pins 1..9 of bank 1, bits 9..17 = pins 1..9 of bank 2),
+        // 'tick' is the sampling time (ms)
+        void    ProcessEncoders(uint32_t raw, uint16_t tick);
+
+        // Direct read of the encoder lines from the expanders (in the 'raw' format above), for the encoder sampler.
+        // In change-notification mode, the expanders are only read if a change is signalled on the IRQ line
+        // (or if 'force'): returns false if they were not read, i.e. the lines are unchanged.
+        bool    sampleEncLines(uint32_t &raw, bool force = false);
+
+        bool    hasEncoders(void)           { return (cfg->nEncoders != 0); }
+        // Raw encoder lines last processed
+        uint32_t encLines(void)             { return encRaw; }
+
         // For custom processing, an encoder object made available (based on the digital input vector),
         EncoderSet  *Encoders(void)       { return &Encs; }
 
@@ -261,6 +346,7 @@ class M10board
 
         // n is 0..1
         LedControl  *getDisplay(byte n)    { return &LEDCTRL[n&0x01]; }
+        bool        hasDisplays(void)      { return cfg->hasDisplays; }
 
 // ALL FOLLOWING DEFINITIONS ARE WRAPPERS:
 // few of them are actually used, therefore we better use direct calls to LedControl objects
@@ -47,6 +47,7 @@ constexpr int8_t    LCD_PWM =  3;
 // ******* Individual control pins
 
 constexpr int8_t    PX_SSn[12]  = { 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38 }; 
+// Pins 10..13 are the IRQ inputs of slots 8..11: the expanders are selected by PX_SSn only
 constexpr int8_t    PX_IRQn[12] = { A8, A9, A10, A11, A12, A13, A14, A15, 10, 11, 12, 13 }; 
 
 constexpr int8_t    LD_CSAn[12] = { 22, 23, 24, 25, 26, 27, -1, -1, -1, -1, -1 }; 
@@ -29,7 +29,7 @@ void attachCommandCallbacks()
     //TODO: build OUTPUT device interface functions:
 
     // Output (LED)
-    // cmdMessenger.attach(kSetPin, Output::OnSet);
+    cmdMessenger.attach(kSetPin, Output::OnSet);
     
     // Block Outputs (Shift reg - IOexp.)
     // cmdMessenger.attach(kSetShiftRegisterPins, OutputShifter::OnSet);
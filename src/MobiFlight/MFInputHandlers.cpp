@@ -2,6 +2,8 @@
 // MFInputHandlers.cpp
 //
 #include "mobiflight.h"
+#include "CtlTable.h"
+#include "AnaInputs.h"
 
 namespace Button {
     
@@ -18,6 +20,22 @@ namespace Button {
         cmdMessenger.sendCmdEnd();
     };
 
+    void OnCtlEvent(uint16_t tag, uint8_t event, int8_t delta)
+    {
+        (void) delta; // Unused
+        uint8_t eventId;
+        switch(event) {
+            case IEV_PRESS:
+            case IEV_REPEAT:    eventId = OnPress;   break;
+            case IEV_RELEASE:   eventId = OnRelease; break;
+            default:            return;
+        }
+        cmdMessenger.sendCmdStart(kButtonChange);
+        cmdMessenger.sendCmdArg(tag);
+        cmdMessenger.sendCmdArg(eventId);
+        cmdMessenger.sendCmdEnd();
+    };
+
     //TODO: OnResync must cycle on ALL release events first, then on ALL press events:
     // the OnResync() function is probably better implemented at higher level by directly calling OnEvent().
     // Code is left below just for reference for the final implementation.
@@ -38,6 +56,13 @@ namespace Button {
 
 namespace Encoder
 {
+    enum {
+        encLeft,
+        encLeftFast,
+        encRight,
+        encRightFast,
+    };
+
     void OnEvent(uint8_t eventId, uint8_t pin, const char *name)
     {
         (void) pin; // Unused
@@ -47,7 +72,35 @@ namespace Encoder
         cmdMessenger.sendCmdEnd();
     };
 
+    void OnCtlEvent(uint16_t tag, uint8_t event, int8_t delta)
+    {
+        (void) delta; // Unused
+        uint8_t eventId;
+        switch(event) {
+            case IEV_DN:        eventId = encLeft;       break;
+            case IEV_FASTDN:    eventId = encLeftFast;   break;
+            case IEV_UP:        eventId = encRight;      break;
+            case IEV_FASTUP:    eventId = encRightFast;  break;
+            default:            return;
+        }
+        cmdMessenger.sendCmdStart(kEncoderChange);
+        cmdMessenger.sendCmdArg(tag);
+        cmdMessenger.sendCmdArg(eventId);
+        cmdMessenger.sendCmdEnd();
+    };
+
+
+}
 
+namespace Analog
+{
+    void OnChange(uint8_t ch, uint16_t value)
+    {
+        cmdMessenger.sendCmdStart(kAnalogChange);
+        cmdMessenger.sendCmdArg(ch);
+        cmdMessenger.sendCmdArg(value);
+        cmdMessenger.sendCmdEnd();
+    };
 }
 
 namespace InputShifter
@@ -117,3 +170,20 @@ namespace InputShifter
     }
 
 }
+
+// Callbacks referenced by index from the board definitions:
+// order must match Config::T_CtlCallback (CB_MFBUTTON, CB_MFENCODER) in ctlTables.h
+static const CTLcallback MFCtlCallbacks[] = {
+    Button::OnCtlEvent,
+    Encoder::OnCtlEvent,
+};
+
+void MF_attachCtlCallbacks(void)
+{
+    CtlTable::setCallbacks(MFCtlCallbacks, sizeof(MFCtlCallbacks)/sizeof(MFCtlCallbacks[0]));
+}
+
+void MF_attachAnaCallback(void)
+{
+    AnaInputs::setCallback(Analog::OnChange);
+}
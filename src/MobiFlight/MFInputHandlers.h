@@ -14,6 +14,8 @@
 // - Device internal logic
 
 #include <Arduino.h>
+#include "inputEvent.h"
+#include "CtlTable.h"
 
 namespace Button
 {
@@ -24,6 +26,9 @@ namespace Button
 
     void OnEvent(uint8_t eventId, uint8_t pin, const char *name);
     //void OnResync(void);     // see comments in .cpp
+
+    // Event callback for button descriptors (see CtlTable.h): the tag is sent in place of the name
+    void OnCtlEvent(uint16_t tag, uint8_t event, int8_t delta);
 }
 
 namespace Encoder
@@ -37,6 +42,15 @@ namespace Encoder
 
     void OnEvent(uint8_t eventId, uint8_t pin, const char *name); // <pin> is unused
     //void OnResync(void);     // Encoders don't have a Resync() operation
+
+    // Event callback for encoder descriptors (see CtlTable.h): the tag is sent in place of the name
+    void OnCtlEvent(uint16_t tag, uint8_t event, int8_t delta);
+}
+
+namespace Analog
+{
+    // Change callback for the filtered analog inputs (see AnaInputs.h): the channel is sent in place of the name
+    void OnChange(uint8_t ch, uint16_t value);
 }
 
 namespace InputShifter
@@ -45,3 +59,9 @@ namespace InputShifter
     //void OnResync(void);     // see comments in .cpp
 }
 
+// Registers the callbacks referenced by the control descriptor tables (see ctlTables.h)
+void MF_attachCtlCallbacks(void);
+
+// Registers the analog input change callback (see AnaInputs.h)
+void MF_attachAnaCallback(void);
+
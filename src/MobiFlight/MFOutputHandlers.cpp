@@ -2,6 +2,8 @@
 // MFOutputHandlers.cpp
 //
 #include "mobiflight.h"
+#include "main.h"
+#include "ioMap.h"
 
 
 namespace Output {
@@ -11,8 +13,22 @@ namespace Output {
         // Read led state argument, interpret string as boolean
         int pin = cmdMessenger.readInt16Arg();
         int state = cmdMessenger.readInt16Arg();
-        //TODO: insert operation function (attach as callback?)
-        // analogWrite(pin, state);
+
+        // Pin is a global address: resolve it to board slot + local target
+        uint16_t e = Config::iomLookup((uint16_t)pin);
+        uint8_t slot = Config::iomSlot(e);
+        if(!isBoardAttached(slot)) return;
+
+        switch(Config::iomKind(e)) {
+        case Config::IOM_OUT:
+            Board[slot].outWrite(Config::iomPin(e), (state != 0));
+            break;
+        case Config::IOM_SEG:
+            Board[slot].segWrite(Config::iomUnit(e), Config::iomDigit(e), Config::iomSegment(e), (state != 0));
+            break;
+        default:
+            break;
+        }
     }
 
 }
@@ -0,0 +1,144 @@
+// =======================================================================
+// @file        ScanScheduler.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Frame-based I/O scan scheduler for all attached M10 boards
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "main.h"
+#include "ScanScheduler.h"
+
+ScanScheduler::ScanScheduler(M10board* brds, uint16_t periodUs)
+:   boards(brds), attached(0), framePeriod(periodUs), frameStart(0), nextSlot(0), resyncCnt(0),
+    resyncIn(0), resyncOut(0)
+{
+    for(uint8_t s = 0; s < MAXSLOTS; s++) {
+        inCnt[s]  = 0;
+        outCnt[s] = 0;
+        scanTime[s] = 0;
+    }
+    clearStats();
+}
+
+void
+ScanScheduler::begin(void)
+{
+    attached = 0;
+    for(uint8_t s = 0; s < MAXSLOTS; s++) {
+        // Boards without a configuration (see boardSetup()) have no expanders to scan
+        if(isBoardAttached(s) && boards[s].configured()) attached |= (1<<s);
+        // All boards are due at the first frame
+        inCnt[s]  = 0;
+        outCnt[s] = 0;
+    }
+    nextSlot = 0;
+    resyncCnt = 0;
+    resyncIn = resyncOut = 0;
+    // First frame is due immediately
+    frameStart = (uint16_t)micros() - framePeriod;
+}
+
+void
+ScanScheduler::clearStats(void)
+{
+    for(uint8_t s = 0; s < MAXSLOTS; s++) {
+        overruns[s] = 0;
+    }
+    frameOverruns = 0;
+    maxFrameTime  = 0;
+}
+
+void
+ScanScheduler::_scanSlot(uint8_t slot, byte mode, bool force)
+{
+    uint16_t t0 = (uint16_t)micros();
+    boards[slot].ScanInOut(mode, force);
+    scanTime[slot] = (uint16_t)micros() - t0;
+}
+
+bool
+ScanScheduler::run(void)
+{
+    uint16_t now = (uint16_t)micros();
+    uint16_t late = (uint16_t)(now - frameStart);
+
+    // Wrap-safe: the subtraction above is valid as long as run() is polled
+    // more often than every 65ms
+    if(late < framePeriod) return false;
+
+    // Time base for all the input processing of this frame
+    FrameClock::latch();
+
+    bool overrun = false;
+
+    // Frame due. If we are more than a whole period late, the schedule is lost:
+    // re-sync to the current time instead of trying to catch up.
+    if(late >= 2*framePeriod) {
+        frameStart = now;
+        overrun = true;
+    } else {
+        frameStart += framePeriod;
+    }
+
+    // Periodic full input re-sync for boards in change-notification mode:
+    // pending for each board until its next scan
+    if(resyncCnt == 0) {
+        resyncIn = resyncOut = attached;
+        resyncCnt = RESYNC_FRAMES;
+    } else {
+        resyncCnt--;
+    }
+
+    // The whole frame runs in a single SPI bus session:
+    // individual expander operations only toggle their CS line
+    MCPS::busBegin();
+
+    uint8_t slot  = nextSlot;
+    uint8_t first = nextSlot;
+    nextSlot = 0;
+
+    do {
+        if(attached & (1<<slot)) {
+            bool inDue  = (inCnt[slot]  == 0);
+            bool outDue = (outCnt[slot] == 0);
+
+            if(inDue || outDue) {
+                // Check whether this board still fits in the frame
+                uint16_t elapsed = (uint16_t)micros() - now;
+                if((uint32_t)elapsed + scanTime[slot] > framePeriod && slot != first) {
+                    // Defer this and all remaining boards: the next frame starts here
+                    nextSlot = slot;
+                    overrun = true;
+                    do {
+                        if((attached & (1<<slot)) && overruns[slot] < 0xFF) overruns[slot]++;
+                        if(++slot >= MAXSLOTS) slot = 0;
+                    } while(slot != first);
+                    break;
+                }
+                // Mode: 0=R+W, 1=R, 2=W
+                uint16_t msk = (1<<slot);
+                bool force = (inDue && (resyncIn & msk)) || (outDue && (resyncOut & msk));
+                _scanSlot(slot, (inDue ? (outDue ? 0 : 1) : 2), force);
+                if(inDue)  resyncIn  &= ~msk;
+                if(outDue) resyncOut &= ~msk;
+                if(inDue)  inCnt[slot]  = boards[slot].inScanDiv();
+                if(outDue) outCnt[slot] = boards[slot].outScanDiv();
+            }
+            if(inCnt[slot])  inCnt[slot]--;
+            if(outCnt[slot]) outCnt[slot]--;
+        }
+        if(++slot >= MAXSLOTS) slot = 0;
+    } while(slot != first);
+
+    MCPS::busEnd();
+
+    uint16_t ft = (uint16_t)micros() - now;
+    if(ft > maxFrameTime) maxFrameTime = ft;
+    if(overrun) frameOverruns++;
+    return true;
+}
+
+// end ScanScheduler.cpp
@@ -0,0 +1,95 @@
+// =======================================================================
+// @file        ScanScheduler.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Frame-based I/O scan scheduler for all attached M10 boards
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef SCANSCHEDULER_H
+#define SCANSCHEDULER_H
+
+#include <Arduino.h>
+#include "M10board.h"
+
+/// The scheduler walks all attached boards (as reported by isBoardAttached())
+/// once per scan frame, with a fixed frame period.
+///
+/// Each board declares (in its board_def_*.h file, through SCAN_IN_DIV / SCAN_OUT_DIV)
+/// how often its inputs and outputs must be refreshed, as a divider of the frame rate;
+/// the scheduler calls M10board::ScanInOut() with the matching mode (R+W, R or W) only
+/// for the boards which are due in the current frame.
+///
+/// Whole-frame latency is bounded: before each board, the time already spent in the frame
+/// plus the last measured scan time of that board is checked against the frame period.
+/// If the deadline would be exceeded, the remaining boards are deferred to the next frame
+/// (which will start from the first deferred board, so no board can starve) and their
+/// overrun counter is incremented.
+///
+/// All expander transfers of a frame are performed within a single SPI bus session
+/// (see MCPS::busBegin()), so that the SPI transaction setup is only performed once per frame.
+///
+/// Boards in change-notification input mode are only read when their IRQ line signals a change;
+/// every RESYNC_FRAMES frames, a full read of all inputs is forced anyway, in order to recover
+/// from any lost notification. The re-sync is kept pending for each board until its inputs
+/// (and outputs) are actually scanned, so that boards deferred or not due in that frame get it too.
+///
+/// The frame time (see FrameClock) is latched at the start of each frame.
+
+class ScanScheduler
+{
+    public:
+        static constexpr uint8_t MAXSLOTS = Config::MAX_BOARDS;
+        static constexpr uint8_t RESYNC_FRAMES = 250;
+
+    private:
+
+        M10board*   boards;
+        uint16_t    attached;               // Bit mask of attached (and configured) slots
+        uint16_t    framePeriod;            // Frame period (us)
+        uint16_t    frameStart;             // Start time of the current frame (low 16 bits of micros())
+        uint8_t     nextSlot;               // Slot the next frame starts from
+        uint8_t     resyncCnt;              // Frames left before next forced full input read
+        uint16_t    resyncIn;               // Bit mask of slots with a forced input read pending
+        uint16_t    resyncOut;              // Bit mask of slots with a forced output rewrite pending
+
+        uint8_t     inCnt[MAXSLOTS];        // Frames left before next input scan (0 = due)
+        uint8_t     outCnt[MAXSLOTS];       // Frames left before next output scan (0 = due)
+
+        // Statistics
+        uint16_t    scanTime[MAXSLOTS];     // Duration of the last scan of each board (us)
+        uint8_t     overruns[MAXSLOTS];     // Frames in which the scan of the board was deferred (saturated at 255)
+        uint16_t    frameOverruns;          // Frames which were started late or had to defer boards
+        uint16_t    maxFrameTime;           // Longest frame execution time seen (us)
+
+        void        _scanSlot(uint8_t slot, byte mode, bool force);
+
+    public:
+
+        // 'brds' is the board array, indexed by slot
+        // 'periodUs' is the frame period in microseconds (max 65535)
+        explicit
+        ScanScheduler(M10board* brds, uint16_t periodUs = 2000);
+
+        // Collect the attached boards and arm the first frame.
+        // To be called after boardSetup().
+        void        begin(void);
+
+        void        setFramePeriod(uint16_t periodUs)   { framePeriod = periodUs; }
+        uint16_t    getFramePeriod(void)                { return framePeriod; }
+
+        // Poll from the main loop: executes a scan frame if due.
+        // Returns true if a frame was executed.
+        bool        run(void);
+
+        // Statistics
+        uint8_t     getOverruns(uint8_t slot)       { return (slot < MAXSLOTS ? overruns[slot] : 0); }
+        uint16_t    getScanTime(uint8_t slot)       { return (slot < MAXSLOTS ? scanTime[slot] : 0); }
+        uint16_t    getFrameOverruns(void)          { return frameOverruns; }
+        uint16_t    getMaxFrameTime(void)           { return maxFrameTime; }
+        void        clearStats(void);
+};
+
+#endif // SCANSCHEDULER_H
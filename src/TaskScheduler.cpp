@@ -0,0 +1,102 @@
+// =======================================================================
+// @file        TaskScheduler.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Cooperative task scheduler with fixed periods, priorities and CPU budgets
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler(Task* tbl, uint8_t n, uint16_t passBudgetUs)
+:   tasks(tbl), nTasks(n > MAXTASKS ? MAXTASKS : n), passBudget(passBudgetUs)
+{
+    for(uint8_t i = 0; i < nTasks; i++) order[i] = i;
+}
+
+void
+TaskScheduler::begin(void)
+{
+    // Insertion sort by priority (stable: same-priority tasks keep the table order)
+    for(uint8_t i = 1; i < nTasks; i++) {
+        uint8_t k = order[i];
+        uint8_t j = i;
+        while(j > 0 && tasks[order[j-1]].priority > tasks[k].priority) {
+            order[j] = order[j-1];
+            j--;
+        }
+        order[j] = k;
+    }
+
+    uint32_t now = micros();
+    for(uint8_t i = 0; i < nTasks; i++) {
+        tasks[i].next    = now;
+        tasks[i].pending = false;
+    }
+    clearStats();
+}
+
+void
+TaskScheduler::clearStats(void)
+{
+    for(uint8_t i = 0; i < nTasks; i++) {
+        tasks[i].runTime  = 0;
+        tasks[i].maxTime  = 0;
+        tasks[i].overruns = 0;
+        tasks[i].missed   = 0;
+    }
+}
+
+void
+TaskScheduler::_runTask(Task &t, uint32_t now)
+{
+    // Advance the schedule only when a new run starts (not for further slices)
+    if(!t.pending && t.period != 0) {
+        if((uint32_t)(now - t.next) >= t.period) {
+            // More than a whole period late: re-sync instead of catching up
+            if(t.missed < 0xFFFF) t.missed++;
+            t.next = now + t.period;
+        } else {
+            t.next += t.period;
+        }
+    }
+
+    uint32_t t0 = micros();
+    t.pending = t.fn(t.budget);
+    uint32_t rt = micros() - t0;
+
+    t.runTime = (rt > 0xFFFF ? 0xFFFF : (uint16_t)rt);
+    if(t.runTime > t.maxTime) t.maxTime = t.runTime;
+    if(t.runTime > t.budget && t.overruns < 0xFFFF) t.overruns++;
+}
+
+uint8_t
+TaskScheduler::run(void)
+{
+    uint32_t start = micros();
+    uint8_t  executed = 0;
+    bool     periodic = false;      // A periodic task has been run in this pass
+
+    for(uint8_t i = 0; i < nTasks; i++) {
+        Task &t = tasks[order[i]];
+        uint32_t now = micros();
+
+        // Wrap-safe due check
+        bool due = t.pending || (t.period == 0) || ((int32_t)(now - t.next) >= 0);
+        if(!due) continue;
+
+        // The first task run in a pass is always allowed, and so is the first periodic one;
+        // others must fit in the remaining budget
+        bool guaranteed = (executed == 0) || (!periodic && t.period != 0);
+        if(!guaranteed && (now - start) + t.budget > passBudget) continue;
+
+        _runTask(t, now);
+        executed++;
+        if(t.period != 0) periodic = true;
+    }
+    return executed;
+}
+
+// end TaskScheduler.cpp
@@ -0,0 +1,93 @@
+// =======================================================================
+// @file        TaskScheduler.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Cooperative task scheduler with fixed periods, priorities and CPU budgets
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <Arduino.h>
+
+/// Tasks are defined in a static table (see Task below), and are executed by polling run()
+/// from the main loop.
+///
+/// - Each task has a period (us); a period of 0 means the task is polled at every pass
+///   (it is expected to perform its own timing, like the ScanScheduler).
+/// - Tasks are served in priority order (0 = highest); all due tasks are executed in the same pass,
+///   as long as their CPU budget fits in the pass budget. The highest-priority due task always runs,
+///   and so does the highest-priority due periodic task (polled tasks are due at every pass, so they
+///   would otherwise take that guarantee away from all periodic tasks below them);
+///   tasks which do not fit are postponed to the next pass.
+/// - A task can perform its work in slices: the task function receives its budget (us) and returns
+///   true if work is left; in that case, it is run again at the next pass(es) until it completes.
+///
+/// All time comparisons are wrap-safe (differences of 32-bit micros() values).
+///
+/// Per-task statistics: last and maximum run time, budget overruns (run time > budget) and missed
+/// deadlines (task started more than a whole period late; the schedule is then re-synced to the
+/// current time instead of trying to catch up).
+
+// Task function: 'budget' is the CPU time allowance (us) for this call.
+// Returns true if the task has more work to do (sliced task), false when done.
+using TaskFn = bool (*)(uint16_t budget);
+
+struct Task {
+    // Definition
+    TaskFn      fn;
+    uint32_t    period;         // Period (us); 0 = polled at every pass
+    uint16_t    budget;         // CPU budget per run (us)
+    uint8_t     priority;       // 0 = highest
+    // State
+    uint32_t    next;           // Due time (micros())
+    bool        pending;        // Sliced task with work left
+    // Statistics
+    uint16_t    runTime;        // Duration of the last run (us)
+    uint16_t    maxTime;        // Longest run seen (us)
+    uint16_t    overruns;       // Runs exceeding the budget
+    uint16_t    missed;         // Missed deadlines
+};
+
+// Shorthand for task table entries
+#define TASK(fn, periodUs, budgetUs, prio)  { (fn), (periodUs), (budgetUs), (prio), 0, false, 0, 0, 0, 0 }
+
+class TaskScheduler
+{
+    public:
+        static constexpr uint8_t MAXTASKS = 8;
+
+    private:
+
+        Task*       tasks;
+        uint8_t     nTasks;
+        uint8_t     order[MAXTASKS];        // Task indexes sorted by priority
+        uint16_t    passBudget;             // CPU time allowance for a pass of run() (us)
+
+        void        _runTask(Task &t, uint32_t now);
+
+    public:
+
+        // 'tbl' is the task table (max MAXTASKS entries)
+        // 'passBudgetUs' is the time allowance for all tasks in a single pass
+        TaskScheduler(Task* tbl, uint8_t n, uint16_t passBudgetUs = 1000);
+
+        // Sort tasks by priority and arm the first runs (all tasks are due immediately)
+        void        begin(void);
+
+        void        setPassBudget(uint16_t us)      { passBudget = us; }
+
+        // Poll from the main loop: executes all due tasks that fit in the pass budget.
+        // Returns the number of tasks executed.
+        uint8_t     run(void);
+
+        // Statistics
+        uint8_t     count(void)                     { return nTasks; }
+        Task*       getTask(uint8_t n)              { return (n < nTasks ? &tasks[n] : nullptr); }
+        void        clearStats(void);
+};
+
+#endif // TASKSCHEDULER_H
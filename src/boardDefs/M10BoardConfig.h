@@ -12,6 +12,8 @@
 #ifndef __M10BOARD_CFG__H__
 #define __M10BOARD_CFG__H__
 
+#include "EncAccel.h"
+
 // This struct defined the position of a LED 
 // driven as a MAX7219's individual segment 
 using LEDonMAX = struct {
@@ -20,7 +22,22 @@ using LEDonMAX = struct {
     byte segment  : 3;
 };
 
-using M10BoardConfig = struct {
+// Debounce filter applied to the digital inputs before the switch/button processing
+enum : uint8_t {
+    SWF_NONE    = 0,    // No filter (buttons / ButtonManager handle debounce)
+    SWF_VCOUNT  = 1,    // Vertical-counter filter: each input is debounced independently (4 scan samples)
+};
+
+// Encoder acceleration profiles (EncAccel::ACC_xxx), one nibble per encoder (#1 in the lowest one).
+// Use as: #define ENC_ACCEL  accelProfiles(EncAccel::ACC_COARSE, EncAccel::ACC_MEDIUM, ...)
+// Encoders not listed use ACC_DEFAULT.
+constexpr uint32_t accelProfiles(uint8_t e1, uint8_t e2 = 0, uint8_t e3 = 0, uint8_t e4 = 0, uint8_t e5 = 0, uint8_t e6 = 0)
+{
+    return ((uint32_t)(e1 & 0x0F))       | ((uint32_t)(e2 & 0x0F) << 4)  | ((uint32_t)(e3 & 0x0F) << 8) |
+           ((uint32_t)(e4 & 0x0F) << 12) | ((uint32_t)(e5 & 0x0F) << 16) | ((uint32_t)(e6 & 0x0F) << 20);
+}
+
+struct M10BoardConfig {
     
     //! TODO (M10) Add control pins on the Mega for the specific board:
     //! PX_SSn, (PX_IRQn), LD_CSAn/LD_CSBn, (LCD_ENn)
@@ -46,6 +63,19 @@ using M10BoardConfig = struct {
     bool        hasDisplays;
     bool        hasLCD;
 
+    // Scan rate dividers: inputs/outputs of the board are refreshed every n-th scan frame (1 = every frame)
+    uint8_t     inScanDiv;
+    uint8_t     outScanDiv;
+
+    // Input filter (SWF_xxx)
+    uint8_t     swFilter;
+
+    // Encoder acceleration profiles (see accelProfiles())
+    uint32_t    encAccel;
+
+    // Read the inputs only when the expanders signal a change on the slot IRQ line
+    bool        inNotify;
+
     uint8_t     nLEDsOnMAX = 0;
     LEDonMAX    *LEDsOnMAX = nullptr;
 
@@ -65,6 +65,23 @@ enum {
 constexpr uint8_t MAX_BOARD_TYPES = 9;
 constexpr uint8_t MAX_BOARDS      = 12;
 
+// Board type installed in each hub slot
+// (same order used for TotObjectMemSize() below and for BoardCtl[] in ctlTables.cpp)
+constexpr uint8_t SlotBoardType[MAX_BOARDS] = {
+    T_01_Radio,         // Radio 1
+    T_01_Radio,         // Radio 2
+    T_02_ADF_DME,
+    T_03_XPDR_OBS_CLK,
+    T_04_AP,
+    T_09_EFIS,
+    T_05_Radio_LCD,
+    T_06_Multi_LCD,
+    T_07_AP_LCD,
+    T_08_Kbd,           // Kbd (AP)
+    T_08_Kbd,           // Kbd (Radio (Audio))
+    T_08_Kbd,           // Kbd (Aux)
+};
+
 // Following values should ideally be computed from definition files
 // of individual boards, but let's not overthink it
 
@@ -32,6 +32,8 @@
 #define ANA_INPUTS      pat(B00000000,B00000000)
 #define N_ENCODERS      2
 #define N_VIRT_ENCODERS 4
+#define SCAN_OUT_DIV    8       // No expander outputs: only an occasional re-sync
+#define ENC_ACCEL       accelProfiles(EncAccel::ACC_FINE, EncAccel::ACC_FINE)     // Frequency knobs
 
 #define N_IOEXP         1
 #define N_DISPLAYS1     2
@@ -44,6 +46,21 @@
 // #define VIEWPORT3       {2,3, 5} //6}
 // #define VIEWPORT4       {2,11,5} //6}
 
+// Control descriptors (see board_def_ctl.inc); pin/encoder names are defined below
+#define BUTTON_LIST \
+    BTN(PB_ENC_A,       CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ENC_B,       CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_PROGRAM,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(SW_COM_NAV_A,   CT_SWITCH,  CB_MFBUTTON,    0, 0, 0) \
+    BTN(SW_1_2_A,       CT_SWITCH,  CB_MFBUTTON,    0, 0, 0) \
+    BTN(SW_COM_NAV_B,   CT_SWITCH,  CB_MFBUTTON,    0, 0, 0) \
+    BTN(SW_1_2_B,       CT_SWITCH,  CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_SWAP_A,      CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_SWAP_B,      CT_PUSH,    CB_MFBUTTON,    0, 0, 0)
+#define ENCODER_LIST \
+    ENC(ENC_SIDE_A,     CB_MFENCODER,   0) \
+    ENC(ENC_SIDE_B,     CB_MFENCODER,   0)
+
 #endif  // BUILDING_CONFIG_DATA
 
 #ifdef BUILDING_CONFIG_RUNTIME
@@ -65,12 +82,10 @@
 #define PB_SWAP_A       15
 #define PB_SWAP_B       16
 
-{
-    // Define INPUTS (buttons)
-    // Define ENCODERS
-    // Define OUTPUTS
-    // Define DISPLAYS (MAX)
-    //......
-}
+// Define INPUTS (buttons)
+// Define ENCODERS
+// Define OUTPUTS
+// Define DISPLAYS (MAX)
+//......
 #endif  // BUILDING_CONFIG_RUNTIME
 // end
\ No newline at end of file
@@ -38,6 +38,18 @@
 #define N_DISPLAYS2     0
 #define N_LCD           0
 
+// Control descriptors (see board_def_ctl.inc); pin/encoder names are defined below
+#define BUTTON_LIST \
+    BTN(PB_ENC_DME,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ENC_ADF,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(SW_DME_RMT,     CT_SWITCH,  CB_MFBUTTON,    0, 0, 0) \
+    BTN(SW_DME_GS_T,    CT_SWITCH,  CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ADF_FLT_ET,  CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ADF_SET_RST, CT_PUSH,    CB_MFBUTTON,    0, 0, 0)
+#define ENCODER_LIST \
+    ENC(ENC_DME_FREQ,   CB_MFENCODER,   0) \
+    ENC(ENC_ADF_FREQ,   CB_MFENCODER,   0)
+
 #endif  // BUILDING_CONFIG_DATA
 
 #ifdef BUILDING_CONFIG_RUNTIME
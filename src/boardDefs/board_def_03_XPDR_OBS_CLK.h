@@ -32,6 +32,7 @@
 #define ANA_INPUTS      pat(B00000000,B00000000)
 #define N_ENCODERS      3
 #define N_VIRT_ENCODERS 0
+#define SCAN_OUT_DIV    8       // No expander outputs: only an occasional re-sync
 
 #define N_IOEXP         1
 #define N_DISPLAYS1     2
@@ -51,6 +52,22 @@
 }
 #define N_LCD           0
 
+// Control descriptors (see board_def_ctl.inc); pin/encoder names are defined below
+#define BUTTON_LIST \
+    BTN(PB_ENC_XPDR,    CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ENC_OBS,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ENC_CLK,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(SW_CLK_TMR,     CT_SWITCH,  CB_MFBUTTON,    0, 0, 0) \
+    BTN(SW_XPDR_ON,     CT_SWITCH,  CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_OBS_RVS,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_CLK_START,   CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_CLK_PAUSE,   CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_CLK_ZERO,    CT_PUSH,    CB_MFBUTTON, 2000, 0, 0)    // Long press: reset
+#define ENCODER_LIST \
+    ENC(ENC_XDPR,       CB_MFENCODER,   0) \
+    ENC(ENC_OBS,        CB_MFENCODER,   0) \
+    ENC(ENC_CLK,        CB_MFENCODER,   0)
+
 #endif  // BUILDING_CONFIG_DATA
 
 #ifdef BUILDING_CONFIG_RUNTIME
@@ -32,6 +32,9 @@
 #define ANA_INPUTS      pat(B00000000,B00000000)
 #define N_ENCODERS      5
 #define N_VIRT_ENCODERS 0
+#define SCAN_OUT_DIV    8       // No expander outputs: only an occasional re-sync
+// Encoder acceleration:       ALT                  VS                 SPD                  HDG                  CRS
+#define ENC_ACCEL       accelProfiles(EncAccel::ACC_COARSE, EncAccel::ACC_FINE, EncAccel::ACC_MEDIUM, EncAccel::ACC_MEDIUM, EncAccel::ACC_MEDIUM)
 
 #define N_IOEXP         2
 #define N_DISPLAYS1     2
@@ -60,6 +63,35 @@
 #define N_LCD           0
 
 
+// Control descriptors (see board_def_ctl.inc); pin/encoder names are defined below
+#define BUTTON_LIST \
+    BTN(PB_ENC_ALT,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ENC_VS,      CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ENC_SPD,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ENC_HDG,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ENC_CRS,     CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ALT,         CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_VS,          CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_SPD,         CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ATARM_ON,    CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_ATARM_OFF,   CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_AP_ON,       CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_AP_OFF,      CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(SW_SPD_MACH,    CT_SWITCH,  CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_HDG,         CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_CRS,         CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_BANK_SET,    CT_PUSH,    CB_MFBUTTON,    0, 500, 250)    /* Repeat: cycle bank limits */ \
+    BTN(PB_LNAV,        CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_VNAV,        CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_APP,         CT_PUSH,    CB_MFBUTTON,    0, 0, 0) \
+    BTN(PB_REV,         CT_PUSH,    CB_MFBUTTON,    0, 0, 0)
+#define ENCODER_LIST \
+    ENC(ENC_ALT,        CB_MFENCODER,   0) \
+    ENC(ENC_VS,         CB_MFENCODER,   0) \
+    ENC(ENC_SPD,        CB_MFENCODER,   0) \
+    ENC(ENC_HDG,        CB_MFENCODER,   0) \
+    ENC(ENC_CRS,        CB_MFENCODER,   0)
+
 #endif  // BUILDING_CONFIG_DATA
 
 #ifdef BUILDING_CONFIG_RUNTIME
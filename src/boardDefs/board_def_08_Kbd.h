@@ -37,6 +37,8 @@
 #define N_DISPLAYS2     0
 #define N_LCD           0
 
+#define SW_FILTER       SWF_VCOUNT  // Keyboard: debounce each key independently
+
 #endif  // BUILDING_CONFIG_DATA
 
 #ifdef BUILDING_CONFIG_RUNTIME
@@ -35,6 +35,7 @@
 #define ANA_INPUTS      pat(B00000000,B00000010)
 #define N_ENCODERS      2
 #define N_VIRT_ENCODERS 4
+#define SCAN_OUT_DIV    8       // No expander outputs: only an occasional re-sync
 
 #define N_IOEXP         2
 #define N_DISPLAYS1     0
@@ -0,0 +1,112 @@
+//===================================================
+//  ctlTables.cpp
+//
+// Control descriptor tables
+//
+// This file builds the BoardCtl[] table (see ctlTables.h) at compile time.
+// The board definition files are included in slot order (the same order used
+// for TotObjectMemSize() in boardDefine.h); for each slot, the descriptor tables
+// of its buttons and encoders are built from the board's BUTTON_LIST / ENCODER_LIST.
+
+#include "ctlTables.h"
+
+namespace Config {
+
+namespace {
+
+#define CTL_CAT_(a, b)      a##b
+#define CTL_CAT(a, b)       CTL_CAT_(a, b)
+
+#define CTL_TAG(n)          ((uint16_t)(CTL_SLOT * IOMAP_SLOTSIZE + (n) - 1))
+#define CTL_T100(ms)        ((uint8_t)(((ms) + 50) / 100))
+#define CTL_T10(ms)         ((uint8_t)(((ms) + 9) / 10))
+
+#define BUILDING_CONFIG_DATA
+
+#include "board_def_clean.inc"
+#include "board_def_01_Radio.h"
+#define CTL_SLOT 0
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_01_Radio.h"
+#define CTL_SLOT 1
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_02_ADF_DME.h"
+#define CTL_SLOT 2
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_03_XPDR_OBS_CLK.h"
+#define CTL_SLOT 3
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_04_AP.h"
+#define CTL_SLOT 4
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_09_EFIS.h"
+#define CTL_SLOT 5
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_05_Radio_LCD.h"
+#define CTL_SLOT 6
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_06_Multi_LCD.h"
+#define CTL_SLOT 7
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_07_AP_LCD.h"
+#define CTL_SLOT 8
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_08_Kbd.h"    // AP
+#define CTL_SLOT 9
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_08_Kbd.h"    // Radio (Audio)
+#define CTL_SLOT 10
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+#include "board_def_clean.inc"
+#include "board_def_08_Kbd.h"    // Aux
+#define CTL_SLOT 11
+#include "board_def_ctl.inc"
+#undef  CTL_SLOT
+
+#undef BUILDING_CONFIG_DATA
+
+#define CTL_SET(s)          { CTL_CAT(_btnp, s), CTL_CAT(_nbtn, s), CTL_CAT(_encp, s), CTL_CAT(_nenc, s) }
+
+static_assert(MAX_BOARDS == 12, "BoardCtl[] must list all slots");
+
+}   // anonymous namespace
+
+const CtlSet BoardCtl[MAX_BOARDS] PROGMEM = {
+    CTL_SET(0),
+    CTL_SET(1),
+    CTL_SET(2),
+    CTL_SET(3),
+    CTL_SET(4),
+    CTL_SET(5),
+    CTL_SET(6),
+    CTL_SET(7),
+    CTL_SET(8),
+    CTL_SET(9),
+    CTL_SET(10),
+    CTL_SET(11),
+};
+
+}
+
+// end
@@ -0,0 +1,50 @@
+// =======================================================================
+// @file        ctlTables.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Control descriptor tables (buttons, encoders) of all board slots
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef __CTLTABLES__H__
+#define __CTLTABLES__H__
+
+#include <Arduino.h>
+#include "boardDefine.h"
+#include "ioMap.h"
+#include "CtlTable.h"
+
+// The descriptor tables (in PROGMEM, see CtlTable.h) are built at compile time from the
+// BUTTON_LIST / ENCODER_LIST definitions of the board_def_*.h files, one set per slot
+// (see board_def_ctl.inc).
+// Tags are unique across all slots:
+//      buttons:    tag = slot * IOMAP_SLOTSIZE + pin - 1   (i.e. the global address of the input, see ioMap.h)
+//      encoders:   tag = slot * IOMAP_SLOTSIZE + enc - 1   (encoders have their own numbering space)
+
+namespace Config {
+
+// Callback indexes used in the board definitions
+// (the callbacks themselves are supplied by the application through CtlTable::setCallbacks())
+enum T_CtlCallback : uint8_t {
+    CB_MFBUTTON  = 0,       // MobiFlight button event
+    CB_MFENCODER = 1,       // MobiFlight encoder event
+    CB_COUNT
+};
+
+// Controls of a slot
+struct CtlSet {
+    const BtnDesc   *btns;
+    uint8_t         nBtns;
+    const EncDesc   *encs;
+    uint8_t         nEncs;
+};
+
+extern const CtlSet BoardCtl[MAX_BOARDS] PROGMEM;
+
+inline void     getCtlSet(uint8_t slot, CtlSet &s)  { memcpy_P(&s, &BoardCtl[slot], sizeof(CtlSet)); }
+
+}
+
+#endif  //!__CTLTABLES__H__
@@ -0,0 +1,147 @@
+//===================================================
+//  ioMap.cpp
+//
+// Global I/O address map
+//
+// This file builds the IOMap[] table (see ioMap.h) at compile time.
+// The board definition files are included in slot order (the same order used
+// for TotObjectMemSize() in boardDefine.h); for each slot, a constexpr description
+// of its I/Os is built, from which all 64 entries of the slot are computed.
+
+#include "ioMap.h"
+
+namespace Config {
+
+namespace {
+
+// I/O description of the board in a slot
+struct SlotIO {
+    uint16_t        digInputs;
+    uint16_t        digOutputs;
+    uint16_t        digInputs2;
+    uint16_t        digOutputs2;
+    uint8_t         nLEDsOnMAX;
+    const LEDonMAX  *LEDsOnMAX;
+};
+
+#define IOMAP_CAT_(a, b)    a##b
+#define IOMAP_CAT(a, b)     IOMAP_CAT_(a, b)
+
+#define BUILDING_CONFIG_DATA
+
+#include "board_def_clean.inc"
+#include "board_def_01_Radio.h"
+#define IOMAP_SLOT 0
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_01_Radio.h"
+#define IOMAP_SLOT 1
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_02_ADF_DME.h"
+#define IOMAP_SLOT 2
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_03_XPDR_OBS_CLK.h"
+#define IOMAP_SLOT 3
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_04_AP.h"
+#define IOMAP_SLOT 4
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_09_EFIS.h"
+#define IOMAP_SLOT 5
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_05_Radio_LCD.h"
+#define IOMAP_SLOT 6
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_06_Multi_LCD.h"
+#define IOMAP_SLOT 7
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_07_AP_LCD.h"
+#define IOMAP_SLOT 8
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_08_Kbd.h"    // AP
+#define IOMAP_SLOT 9
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_08_Kbd.h"    // Radio (Audio)
+#define IOMAP_SLOT 10
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+#include "board_def_clean.inc"
+#include "board_def_08_Kbd.h"    // Aux
+#define IOMAP_SLOT 11
+#include "board_def_iomap.inc"
+#undef  IOMAP_SLOT
+
+#undef BUILDING_CONFIG_DATA
+
+// Entry for an expander pin (bank 0..1, bit 0..15)
+constexpr uint16_t expEntry(uint16_t ins, uint16_t outs, uint8_t slot, uint8_t bank, uint8_t bit)
+{
+    return ((outs & (1U << bit)) ? iomEntry(IOM_OUT, slot, (bank << 4) | bit)
+          : (ins  & (1U << bit)) ? iomEntry(IOM_IN,  slot, (bank << 4) | bit)
+          : 0);
+}
+
+// Entry for a LED on a MAX segment
+constexpr uint16_t segEntry(const LEDonMAX &led, uint8_t slot)
+{
+    return iomEntry(IOM_SEG, slot, (led.unit << 6) | (led.digit << 3) | led.segment);
+}
+
+// Entry for local address 'la' (0..63) of slot 'slot'
+constexpr uint16_t ioEntry(const SlotIO &d, uint8_t slot, uint8_t la)
+{
+    return ((la < 16) ? expEntry(d.digInputs,  d.digOutputs,  slot, 0, la)
+          : (la < 32) ? expEntry(d.digInputs2, d.digOutputs2, slot, 1, la-16)
+          : ((la-32) < d.nLEDsOnMAX) ? segEntry(d.LEDsOnMAX[la-32], slot)
+          : 0);
+}
+
+#define IOMAP_E(s, la)      ioEntry(IOMAP_CAT(_slot, s), s, la)
+#define IOMAP_R8(s, b)      IOMAP_E(s, b+0), IOMAP_E(s, b+1), IOMAP_E(s, b+2), IOMAP_E(s, b+3), \
+                            IOMAP_E(s, b+4), IOMAP_E(s, b+5), IOMAP_E(s, b+6), IOMAP_E(s, b+7)
+#define IOMAP_SLOTENTRIES(s) \
+                            IOMAP_R8(s,  0), IOMAP_R8(s,  8), IOMAP_R8(s, 16), IOMAP_R8(s, 24), \
+                            IOMAP_R8(s, 32), IOMAP_R8(s, 40), IOMAP_R8(s, 48), IOMAP_R8(s, 56)
+
+static_assert(IOMAP_SLOTSIZE == 64, "IOMAP_SLOTENTRIES() must match IOMAP_SLOTSIZE");
+static_assert(MAX_BOARDS == 12, "IOMap[] must list all slots");
+
+}   // anonymous namespace
+
+const uint16_t IOMap[IOMAP_SIZE] PROGMEM = {
+    IOMAP_SLOTENTRIES(0),
+    IOMAP_SLOTENTRIES(1),
+    IOMAP_SLOTENTRIES(2),
+    IOMAP_SLOTENTRIES(3),
+    IOMAP_SLOTENTRIES(4),
+    IOMAP_SLOTENTRIES(5),
+    IOMAP_SLOTENTRIES(6),
+    IOMAP_SLOTENTRIES(7),
+    IOMAP_SLOTENTRIES(8),
+    IOMAP_SLOTENTRIES(9),
+    IOMAP_SLOTENTRIES(10),
+    IOMAP_SLOTENTRIES(11),
+};
+
+}
+
+// end
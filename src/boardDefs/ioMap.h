@@ -0,0 +1,66 @@
+// =======================================================================
+// @file        ioMap.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Global I/O address map
+//              (GA = LA + baseOffset[slot], with baseOffset[slot] = slot * 64)
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef __IOMAP__H__
+#define __IOMAP__H__
+
+#include <Arduino.h>
+#include "boardDefine.h"
+
+// Global I/O addresses (as used by MobiFlight) are built as:
+//      GA = LA + slot * IOMAP_SLOTSIZE
+// where LA is the board-local address (0-based, i.e. board pin - 1):
+//      LA  0..15   I/O expander, bank 1
+//      LA 16..31   I/O expander, bank 2
+//      LA 32..63   LEDs driven as individual MAX7219 segments (index in the board's LEDS_ON_MAX list)
+//
+// The IOMap[] table (in PROGMEM) is built at compile time from the board_def_*.h files;
+// each GA resolves in constant time to a packed entry:
+//
+//      bit 15..14  kind        (IOM_NONE, IOM_OUT, IOM_IN, IOM_SEG)
+//      bit 13..10  slot
+//      bit  9..0   for IOM_OUT/IOM_IN:     bit 4 = bank (0..1), bits 3..0 = bit (0..15)
+//                  for IOM_SEG:            bits 7..6 = MAX unit (0..3), bits 5..3 = digit, bits 2..0 = segment
+
+namespace Config {
+
+constexpr uint8_t  IOMAP_SLOTSIZE = 64;
+constexpr uint16_t IOMAP_SIZE     = (uint16_t)MAX_BOARDS * IOMAP_SLOTSIZE;
+
+enum T_IOMapKind : uint8_t {
+    IOM_NONE = 0,       // Unused address
+    IOM_OUT  = 1,       // Expander output pin
+    IOM_IN   = 2,       // Expander input pin
+    IOM_SEG  = 3,       // LED on MAX7219 segment
+};
+
+extern const uint16_t IOMap[IOMAP_SIZE] PROGMEM;
+
+// Entry packing
+constexpr uint16_t  iomEntry(uint8_t kind, uint8_t slot, uint16_t payload)
+                        { return (uint16_t)(((uint16_t)kind << 14) | ((uint16_t)(slot & 0x0F) << 10) | (payload & 0x03FF)); }
+
+// Entry lookup (GA out of range resolves to IOM_NONE)
+inline uint16_t     iomLookup(uint16_t ga)  { return (ga < IOMAP_SIZE ? pgm_read_word(&IOMap[ga]) : 0); }
+
+// Entry decoding
+inline uint8_t      iomKind(uint16_t e)     { return (e >> 14); }
+inline uint8_t      iomSlot(uint16_t e)     { return ((e >> 10) & 0x0F); }
+inline uint8_t      iomBank(uint16_t e)     { return ((e >> 4) & 0x01); }
+inline uint8_t      iomBit(uint16_t e)      { return (e & 0x0F); }
+inline uint8_t      iomPin(uint16_t e)      { return (e & 0x1F) + 1; }     // Board pin (1..32) for IOM_OUT/IOM_IN
+inline uint8_t      iomUnit(uint16_t e)     { return ((e >> 6) & 0x03); }
+inline uint8_t      iomDigit(uint16_t e)    { return ((e >> 3) & 0x07); }
+inline uint8_t      iomSegment(uint16_t e)  { return (e & 0x07); }
+
+}
+
+#endif  //!__IOMAP__H__
@@ -23,12 +23,15 @@ void crashHandler(void);
 
 memPool<MEM_POOL_SIZE>  pool(crashHandler);
 M10board                Board[Config::MAX_BOARDS];
+InputImage              InImage;
+InputEvents             InEvents;
+ScanScheduler           Scanner(Board);
+uint8_t                 BtnSlot = 0;
 
 // =================================
 //  Local vars
 // =================================
 
-ButtonManager<MAX_TOT_BUTTONS>   BtnMgr;
 EncManager<MAX_TOT_ENCS>         EncMgr;
 
 // =================================
@@ -42,9 +45,10 @@ void crashHandler(void)
     // If available, flash a LED or something.
 }
 
+// Button objects go to the board selected by BtnSlot (their pins are relative to that board)
 void AddButton(Button *bp) 
 {
-    BtnMgr.add(bp);
+    if(BtnSlot < Config::MAX_BOARDS) Board[BtnSlot].addButton(bp);
 } 
 
 void AddEncoder(ManagedEnc *ep) 
@@ -52,18 +56,116 @@ void AddEncoder(ManagedEnc *ep)
     EncMgr.add(ep);
 } 
 
+// After a scan frame, detect input changes across all boards in a single pass
+// and only process the boards whose inputs changed; switches are also processed on boards
+// which need it at every frame (see M10board::switchesBusy())
+void processInputs(void)
+{
+    uint16_t chg = InImage.update();
+    for(uint8_t slot = 0; slot < Config::MAX_BOARDS; slot++, chg >>= 1) {
+        if(!isBoardAttached(slot) || !Board[slot].configured()) continue;
+        if((chg & 0x01) || Board[slot].switchesBusy()) Board[slot].ProcessSwitches();
+        // Encoders are fed by the sampler, if running
+        if((chg & 0x01) && !EncSampler::active()) Board[slot].ProcessEncoders();
+    }
+}
+
+// =================================
+//  Tasks
+// =================================
+
+bool inputsFresh = false;
+
+// I/O scan: the scanner performs its own frame timing
+bool taskScan(uint16_t budget)
+{
+    if(Scanner.run()) inputsFresh = true;
+    return false;
+}
+
+// Input processing: encoder samples taken at each 1ms tick (see loop()), then changes after each new scan frame
+bool taskEncoders(uint16_t budget)
+{
+    if(EncSampler::active()) EncSampler::process();
+    if(inputsFresh) {
+        inputsFresh = false;
+        processInputs();
+    }
+    return false;
+}
+
+// Analog inputs: publishes the values of the last complete ADC sampler round
+// (read by the analog buttons at the next button check), and reports the filtered changes
+bool taskAnalog(uint16_t budget)
+{
+    if(AdcSampler::process()) AnaInputs::update();
+    return AnaInputs::report(FrameClock::now16());
+}
+
+// Input events: invokes the callbacks for the events queued by the input processors
+// (which may send messages to the host), as many as fit in the budget
+bool taskEvents(uint16_t budget)
+{
+    uint32_t    t0 = micros();
+    InputEvent  ev;
+
+    while(InEvents.pop(ev)) {
+        switch(ev.type & IES_MASK) {
+            case IES_BTNADV:    ButtonAdv::dispatch(ev);    break;
+            case IES_BTNEVT:    ButtonEvt::dispatch(ev);    break;
+            case IES_ENC:       ManagedEnc::dispatch(ev);   break;
+            case IES_BTNTBL:
+            case IES_ENCTBL:    CtlTable::dispatch(ev);     break;
+            default: break;
+        }
+        if((uint32_t)(micros() - t0) >= budget) break;
+    }
+    return !InEvents.empty();
+}
+
+// Serial command RX/TX
+bool taskSerial(uint16_t budget)
+{
+    MF_loop();
+    return false;
+}
+
+// Display refresh: transmits changed digits, one display line per slice
+bool taskDisplay(uint16_t budget)
+{
+    static uint8_t slot = 0;
+    static uint8_t line = 0;
+
+    while(slot < Config::MAX_BOARDS) {
+        if(isBoardAttached(slot) && Board[slot].hasDisplays()) {
+            Board[slot].getDisplay(line)->transmit(1);
+            if(++line > 1) { line = 0; slot++; }
+            return (slot < Config::MAX_BOARDS);
+        }
+        slot++;
+    }
+    slot = 0;
+    return false;
+}
+
+// The scan frame (see Scanner) is 2000us: the pass budget covers a full frame plus the input processing
+Task TaskTable[] = {
+    //    function      period(us)  budget(us)  priority
+    TASK(taskScan,      0,          1500,       0),
+    TASK(taskEncoders,  1000,       300,        1),
+    TASK(taskEvents,    1000,       400,        2),
+    TASK(taskSerial,    1000,       300,        3),
+    TASK(taskAnalog,    5000,       300,        4),
+    TASK(taskDisplay,   20000,      400,        5),
+};
+
+TaskScheduler   Tasks(TaskTable, sizeof(TaskTable)/sizeof(TaskTable[0]), 2000);
+
 // =================================
 //  Test stuff
 // =================================
 
 unsigned long counter[4];
-unsigned long ticker;
-byte toggle1 = 1;
-unsigned long ticker2;
-byte toggle2 = 1;
-
-M10BoardConfig    cfg;
-M10board        board;
 
 char dispbuf[8];
 // Converts a counter in a displayable string for LED displays
@@ -93,37 +195,12 @@ void appSetup()
 {
     Button::setCollector(AddButton);
     ManagedEnc::setCollector(AddEncoder);
-}
-
-
-void boardSetup() 
-{
-// FOR EACH (installed) BOARD:
-    //BoardNumber 1;
-    board.setIOMode(0,0xFFFF);            // All inputs
-    board.setPUMode(0,0xFFFF);            // Pull-ups on all inputs
-    board.setIOMode(1,0xFFFF);            // All inputs
-    board.setPUMode(1,0xFFFF);            // Pull-ups on all inputs
-
-    // Board base configuration
-    // board.setBoardCfg((M10BoardConfig *)&BOARD_CFG);
-    // Custom app config
-    //board.init();
-    // Board configuration adjustments after custom cfg
-    board.setBoardPostCfg();
-
-    for(byte i=1; i<5; i++) {
-        // board.dispClear(i);
-        // board.dispWidth(i, 6);
-        // board.dispIntensity(i, 15);
-        // board.dispShutdown(i, false);
-    }
-    // board.dispWrite(1, (byte *)"012345", 0x08);
-    // board.dispWrite(2, (byte *)"ABCDE ", 0x08);
-    // board.dispWrite(3, (byte *)"67890 ", 0x08);
-    // board.dispWrite(4, (byte *)"F0123 ", 0x08);
-    // board.dispTransmit(0);
-// END FOR
+    // Callbacks are invoked by taskEvents, outside of the input scan
+    Button::setEventQueue(&InEvents);
+    ManagedEnc::setEventQueue(&InEvents);
+    // Controls described by the board tables (see ctlTables.h) report through the MobiFlight handlers
+    MF_attachCtlCallbacks();
+    CtlTable::setEventQueue(&InEvents);
 }
 
 
@@ -134,39 +211,30 @@ void setup()
     counter[2] = 0x00000000;
     counter[3] = 0x00000000;
 
-    ticker = millis()+1000;
-    ticker2 = millis()+1;
-
     //Serial.begin(115200);
     Serial.begin(19200);
 
     appSetup();
+    MF_setup();
 
     boardSetup();
 
+    Scanner.begin();
+    EncSampler::begin(Board);
+    AdcSampler::begin(Board);
+    AnaInputs::begin();
+    MF_attachAnaCallback();
+    if(AdcSampler::active()) Button::setAnalogReader(AdcSampler::readPin);
+    Tasks.begin();
 }
 
 //===========================================================================
 
 void loop() {
 
-    board.ScanInOut();
-
-    if(millis()>=ticker) {
-        ticker = millis()+200;
-
-        counter[1] = board.getIns(0);
-        counter2buf(0);
-        // board.dispWrite(1, (byte *)dispbuf, 0x04);
-        counter2buf(1);
-        // board.dispWrite(2, (byte *)dispbuf, 0x04);
-        // board.dispTransmit(0);
-    }
-    if(millis()>=ticker2) {
-        ticker2 = millis()+1;
-        //f_FastdigitalWrite(8, (toggle2&0x01));
-        toggle2++;
-    }
+    // Encoder samples are taken here (between tasks, never during a bus session) as soon as they are due
+    EncSampler::poll();
+    Tasks.run();
 }
 
 //--- End -------------------
@@ -16,6 +16,11 @@
 #include <stdint.h>
 #include "memPool.h"
 #include "M10board.h"
+#include "ScanScheduler.h"
+#include "TaskScheduler.h"
+#include "EncSampler.h"
+#include "AdcSampler.h"
+#include "AnaInputs.h"
 
 //--------------------------------------------
 // Costants
@@ -47,6 +52,11 @@ constexpr uint16_t MEM_POOL_SIZE = Config::TotObjectMemSize() + SpareRoom;
 
 extern memPool<MEM_POOL_SIZE>   pool;
 extern M10board                 Board[Config::MAX_BOARDS];
+extern ScanScheduler            Scanner;
+extern InputImage               InImage;
+extern InputEvents              InEvents;
+extern TaskScheduler            Tasks;
+extern uint8_t                  BtnSlot;    // Board receiving the button objects being made (see AddButton())
 
 //--------------------------------------------
 // User vars
@@ -60,6 +70,12 @@ extern M10board                 Board[Config::MAX_BOARDS];
 void boardSetup(void); 
 bool isBoardAttached(uint8_t slot);    
 
+// from mobiflight.cpp:
+void MF_setup(void);
+void MF_loop(void);
+void MF_attachCtlCallbacks(void);
+void MF_attachAnaCallback(void);
+
 //--------------------------------------------
 // Management vars
 //--------------------------------------------
@@ -0,0 +1,54 @@
+// =======================================================================
+// @file        Arduino.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Minimal Arduino core replacement for the host (native) tests
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef ARDUINO_NATIVE_H
+#define ARDUINO_NATIVE_H
+
+// Only what the libraries under test use: flash is plain memory, and time is driven
+// by the tests (see FrameClock::setSource()).
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define PROGMEM
+#define pgm_read_byte(p)    (*(const uint8_t *)(p))
+#define pgm_read_word(p)    (*(const uint16_t *)(p))
+#define memcpy_P            memcpy
+
+#define lowByte(w)          ((uint8_t)((w) & 0xFF))
+#define highByte(w)         ((uint8_t)((w) >> 8))
+#define bitWrite(v, b, on)  ((on) ? ((v) |= (1UL << (b))) : ((v) &= ~(1UL << (b))))
+
+#ifndef F_CPU
+#define F_CPU               16000000UL
+#endif
+
+#define LOW                 0
+#define HIGH                1
+#define SDA                 20
+#define SCL                 21
+
+#define INPUT               0x0
+#define OUTPUT              0x1
+#define INPUT_PULLUP        0x2
+
+// No HW pins: inputs under test are supplied as vectors
+inline void pinMode(uint8_t pin, uint8_t mode)      { (void)pin; (void)mode; }
+inline void digitalWrite(uint8_t pin, uint8_t val)  { (void)pin; (void)val; }
+inline int  digitalRead(uint8_t pin)                { (void)pin; return HIGH; }
+inline int  analogRead(uint8_t pin)                 { (void)pin; return 0; }
+
+inline unsigned long millis(void)   { return 0; }
+inline unsigned long micros(void)   { return 0; }
+
+#endif // ARDUINO_NATIVE_H
@@ -0,0 +1,20 @@
+// =======================================================================
+// @file        FastArduino.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Replacement of the FastArduino library for the host (native) tests
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef _FastArduino_h
+#define _FastArduino_h
+
+// The fast pin functions are plain pin functions on the host
+#include "Arduino.h"
+
+#define FdigitalRead(a)     digitalRead(a)
+#define FdigitalWrite(a,b)  digitalWrite(a,b)
+
+#endif // _FastArduino_h
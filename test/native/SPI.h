@@ -0,0 +1,63 @@
+// =======================================================================
+// @file        SPI.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Simulated Arduino SPI library, counting bus transactions,
+//              for the host (native) tests of the MCP23S17 driver
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef SPI_NATIVE_H
+#define SPI_NATIVE_H
+
+#include <stdint.h>
+
+#define MSBFIRST    1
+#define SPI_MODE0   0x00
+
+class SPISettings
+{
+    public:
+        SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode)
+        { (void)clock; (void)bitOrder; (void)dataMode; }
+};
+
+/// No device is on the bus: transfer() always reads 0.
+/// The counters record what a real bus would see:
+///   transactions  beginTransaction() calls (SPI settings applied, interrupts masked)
+///   transfers     bytes exchanged
+///   nested        beginTransaction() while a transaction was already open (must never happen)
+///   outside       bytes exchanged outside of a transaction (must never happen)
+class SPIClass
+{
+    public:
+        uint16_t    transactions = 0;
+        uint16_t    transfers    = 0;
+        uint16_t    nested       = 0;
+        uint16_t    outside      = 0;
+        bool        open         = false;
+
+        void    begin(void)     {}
+        void    beginTransaction(const SPISettings &s)
+        {
+            (void)s;
+            if(open) nested++;
+            open = true;
+            transactions++;
+        }
+        void    endTransaction(void)    { open = false; }
+        uint8_t transfer(uint8_t b)
+        {
+            (void)b;
+            if(!open) outside++;
+            transfers++;
+            return 0;
+        }
+        void    clear(void)     { transactions = transfers = nested = outside = 0; }
+};
+
+static SPIClass SPI;
+
+#endif // SPI_NATIVE_H
@@ -0,0 +1,199 @@
+// =======================================================================
+// @file        TWIsim.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Simulated AVR TWI peripheral with a register-based slave
+//              device, for the host (native) tests of TWIQueue
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef TWISIM_H
+#define TWISIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#ifndef _BV
+#define _BV(b)  (1 << (b))
+#endif
+
+// TWCR bits
+#define TWINT   7
+#define TWEA    6
+#define TWSTA   5
+#define TWSTO   4
+#define TWWC    3
+#define TWEN    2
+#define TWIE    0
+
+void TWI_vect(void);
+
+/// The peripheral reacts to writes to TWCR like the real one, but completes each bus operation
+/// immediately: the interrupt it raises is served by run(), which stands for the CPU taking the
+/// TWI interrupt.
+/// A single slave device is on the bus: an MCP23017-like register file (8-bit register pointer
+/// set by the first byte written, auto-incremented on each data byte).
+/// Every bus event is appended to log:
+///   S / Sr / P        start, repeated start, stop
+///   A20W / A20R       address + direction (a trailing '-' marks a NACK from the slave)
+///   12                byte written by the master
+///   <34               byte read by the master (a trailing '-' marks the master's NACK)
+class TWIsim
+{
+    public:
+        struct Ctl {
+            uint8_t v;
+            operator uint8_t() const    { return v; }
+            Ctl& operator=(uint8_t cmd);
+        };
+
+        Ctl         cr;                 // TWCR
+        uint8_t     dr;                 // TWDR
+        uint8_t     sr;                 // TWSR
+        uint8_t     br;                 // TWBR
+
+        uint8_t     devAddr;            // 7-bit address of the slave device
+        uint8_t     regs[32];           // Slave registers
+        int16_t     nackAt;             // Slave NACKs byte n written in a transaction (0 = register address; -1 = never)
+        std::string log;
+
+        TWIsim(void)    { reset(); }
+
+        void reset(void)
+        {
+            cr.v = dr = sr = br = 0;
+            devAddr = 0x20;
+            memset(regs, 0, sizeof(regs));
+            nackAt = -1;
+            log.clear();
+            _mode = IDLE;
+            _busy = _irq = false;
+        }
+
+        /// Serve the pending interrupts (with the ISR), until the bus is idle
+        void run(void)
+        {
+            while(_irq && (cr.v & _BV(TWIE))) {
+                _irq = false;
+                TWI_vect();
+            }
+        }
+
+        bool busy(void)     { return _busy; }
+
+        void command(uint8_t cmd);
+
+    private:
+        enum { IDLE, ADDR, MT, MR } _mode;
+        bool        _busy;              // Bus owned (between START and STOP)
+        bool        _irq;               // TWINT raised
+        bool        _ptrSet;            // Register pointer written in this transaction
+        uint8_t     _ptr;
+        uint8_t     _nw;                // Bytes written in this transaction
+
+        void _event(const char *fmt, uint8_t b = 0)
+        {
+            char s[8];
+            snprintf(s, sizeof(s), fmt, b);
+            if(!log.empty()) log += ' ';
+            log += s;
+        }
+
+        void _done(uint8_t status)
+        {
+            sr = status;
+            cr.v |= _BV(TWINT);
+            _irq = true;
+        }
+};
+
+inline TWIsim&
+twiSim(void)
+{
+    static TWIsim sim;
+    return sim;
+}
+
+inline TWIsim::Ctl&
+TWIsim::Ctl::operator=(uint8_t cmd)
+{
+    twiSim().command(cmd);
+    return *this;
+}
+
+inline void
+TWIsim::command(uint8_t cmd)
+{
+    // Writing TWINT=1 clears the flag and starts the operation; STOP completes at once
+    cr.v = cmd & ~(_BV(TWINT) | _BV(TWSTO));
+    if(!(cmd & _BV(TWINT)) || !(cmd & _BV(TWEN))) return;
+
+    if(cmd & _BV(TWSTO)) {
+        if(_busy) _event("P");
+        _busy = false;
+        _mode = IDLE;
+    }
+    if(cmd & _BV(TWSTA)) {
+        _event(_busy ? "Sr" : "S");
+        _done(_busy ? 0x10 : 0x08);         // TW_REP_START / TW_START
+        _busy = true;
+        _mode = ADDR;
+        _nw = 0;
+        return;
+    }
+    if(cmd & _BV(TWSTO)) return;
+
+    switch(_mode) {
+    case ADDR: {
+        bool rd  = (dr & 1);
+        bool ack = ((dr >> 1) == devAddr);
+        char fmt[8];
+        snprintf(fmt, sizeof(fmt), "A%%02X%c%s", (rd ? 'R' : 'W'), (ack ? "" : "-"));
+        _event(fmt, dr >> 1);
+        if(!ack) {
+            _mode = IDLE;
+            _done(rd ? 0x48 : 0x20);        // TW_MR_SLA_NACK / TW_MT_SLA_NACK
+        } else if(rd) {
+            _mode = MR;
+            _done(0x40);                    // TW_MR_SLA_ACK
+        } else {
+            _mode = MT;
+            _ptrSet = false;
+            _done(0x18);                    // TW_MT_SLA_ACK
+        }
+        break;
+    }
+    case MT:
+        _event("%02X", dr);
+        if(_nw++ == nackAt) {
+            _done(0x30);                    // TW_MT_DATA_NACK
+            break;
+        }
+        if(!_ptrSet) {
+            _ptr = dr;
+            _ptrSet = true;
+        } else {
+            regs[_ptr++ % sizeof(regs)] = dr;
+        }
+        _done(0x28);                        // TW_MT_DATA_ACK
+        break;
+    case MR:
+        dr = regs[_ptr++ % sizeof(regs)];
+        _event((cmd & _BV(TWEA)) ? "<%02X" : "<%02X-", dr);
+        _done((cmd & _BV(TWEA)) ? 0x50 : 0x58);     // TW_MR_DATA_ACK / TW_MR_DATA_NACK
+        break;
+    default:
+        break;
+    }
+}
+
+// Registers, as seen by the code under test
+#define TWCR    (twiSim().cr)
+#define TWDR    (twiSim().dr)
+#define TWSR    (twiSim().sr)
+#define TWBR    (twiSim().br)
+
+#endif // TWISIM_H
@@ -0,0 +1,24 @@
+// =======================================================================
+// @file        interrupt.h
+//
+// @project     M10_Mobiflight
+//
+// @details     AVR interrupt definitions for the host (native) tests:
+//              ISRs are plain functions, called by the simulated peripherals
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef AVR_INTERRUPT_NATIVE_H
+#define AVR_INTERRUPT_NATIVE_H
+
+#include <avr/io.h>
+
+#define ISR(vect)   void vect(void)
+
+static uint8_t SREG = 0;
+
+inline void cli(void) {}
+inline void sei(void) {}
+
+#endif // AVR_INTERRUPT_NATIVE_H
@@ -0,0 +1,18 @@
+// =======================================================================
+// @file        io.h
+//
+// @project     M10_Mobiflight
+//
+// @details     AVR register definitions for the host (native) tests:
+//              only the TWI peripheral, simulated by TWIsim
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef AVR_IO_NATIVE_H
+#define AVR_IO_NATIVE_H
+
+#include <string.h>
+#include "TWIsim.h"
+
+#endif // AVR_IO_NATIVE_H
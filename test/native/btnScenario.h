@@ -0,0 +1,176 @@
+// =======================================================================
+// @file        btnScenario.h
+//
+// @project     M10_Mobiflight
+//
+// @details     Button dispatch scenario shared by the host tests of the
+//              virtual and devirtualized (BTN_DEVIRT) builds
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#ifndef BTNSCENARIO_H
+#define BTNSCENARIO_H
+
+// BTN_DEVIRT changes the button classes, so each dispatch mode is a separate test program
+// (test_btnvirtual, test_btndevirt): both run this same scenario and must get the same events.
+// Events are checked per button, since the devirtualized manager processes buttons by type group.
+
+#include <unity.h>
+#include <type_traits>
+#include "Button_all.h"
+#include "ButtonManager.h"
+
+// The libraries are not built for the native env (see platformio.ini): pull in their sources
+#include "FrameClock.cpp"
+#include "CtlTable.cpp"
+#include "Button.cpp"
+#include "ButtonAdv.cpp"
+#include "ButtonAna.cpp"
+#include "ButtonBas.cpp"
+#include "ButtonEnc.cpp"
+#include "ButtonEvt.cpp"
+
+// Simulated time (ms)
+static uint32_t simMs;
+static uint32_t simClock(void)  { return simMs; }
+
+// Buttons of both types on interleaved pins: ButtonEvt on odd pins, ButtonAdv on even pins;
+// the tag is the pin number
+static const uint8_t NBTN = 6;
+enum { EV_PRESS = 0, EV_RELEASE, EV_LONG, EV_N };
+static uint8_t  evCnt[NBTN+1][EV_N];
+static uint32_t evFirst[NBTN+1][EV_N];  // Time of the first event of each kind
+
+static void logEvent(Button *b, uint8_t ev)
+{
+    uint16_t tag;
+    b->getTag(&tag);
+    if(tag > NBTN) return;
+    if(evCnt[tag][ev]++ == 0) evFirst[tag][ev] = simMs;
+}
+static void evtPress(ButtonEvt *b)      { logEvent(b, EV_PRESS); }
+static void evtRelease(ButtonEvt *b)    { logEvent(b, EV_RELEASE); }
+static void evtLong(ButtonEvt *b)       { logEvent(b, EV_LONG); }
+static void advPress(ButtonAdv *b)      { logEvent(b, EV_PRESS); }
+static void advRelease(ButtonAdv *b)    { logEvent(b, EV_RELEASE); }
+static void advLong(ButtonAdv *b)       { logEvent(b, EV_LONG); }
+
+static ButtonManager<16>    *mgr;
+static uint8_t              vec[2];
+
+static void setPin(uint8_t pin, bool on)
+{
+    uint8_t b = pin-1;
+    if(on) vec[b>>3] |= (1 << (b&7)); else vec[b>>3] &= ~(1 << (b&7));
+}
+
+// Run passes every 2 ms for <ms> ms
+static void run(uint16_t ms)
+{
+    for(uint16_t t = 0; t < ms; t += 2) {
+        simMs += 2;
+        FrameClock::latch();
+        mgr->checkButtons(vec);
+    }
+}
+
+void setUp(void)
+{
+    static uint8_t mem[sizeof(ButtonManager<16>)];
+    static uint8_t btnMem[NBTN][sizeof(ButtonAdv) > sizeof(ButtonEvt) ? sizeof(ButtonAdv) : sizeof(ButtonEvt)];
+
+    simMs = 1000;
+    FrameClock::setSource(simClock);
+    FrameClock::latch();
+    memset(vec, 0, sizeof(vec));
+    memset(evCnt, 0, sizeof(evCnt));
+    mgr = new (mem) ButtonManager<16>();
+    for(uint8_t p = 1; p <= NBTN; p++) {
+        if(p & 1) {
+            ButtonEvt &b = ButtonEvt::make(btnMem[p-1]).pin(p, false).tag((uint16_t)p);
+            b.callbacks(evtPress, evtRelease, evtLong);
+            b.enableRepeat(p == 1);
+            mgr->add(&b);
+        } else {
+            ButtonAdv &b = ButtonAdv::make(btnMem[p-1]).pin(p, false).tag((uint16_t)p);
+            b.callbacks(advPress, advRelease, advLong);
+            mgr->add(&b);
+        }
+    }
+    mgr->initButtons(vec);
+    memset(evCnt, 0, sizeof(evCnt));
+}
+
+void tearDown(void) {}
+
+// Long press and repeat (manager defaults: long press at 600ms, repeat after 400ms every 200ms)
+void test_hold(void)
+{
+    setPin(1, true);
+    setPin(2, true);
+    run(900);
+    setPin(1, false);
+    setPin(2, false);
+    run(100);
+    // Press, then repeats at 400, 600 and 800ms (input validated after the debounce time)
+    TEST_ASSERT_EQUAL_UINT8(4, evCnt[1][EV_PRESS]);
+    TEST_ASSERT_EQUAL_UINT8(1, evCnt[1][EV_LONG]);
+    TEST_ASSERT_EQUAL_UINT8(1, evCnt[1][EV_RELEASE]);
+    // ButtonAdv has no repeat
+    TEST_ASSERT_EQUAL_UINT8(1, evCnt[2][EV_PRESS]);
+    TEST_ASSERT_EQUAL_UINT8(1, evCnt[2][EV_LONG]);
+    TEST_ASSERT_EQUAL_UINT8(1, evCnt[2][EV_RELEASE]);
+    // Same timing for both types
+    TEST_ASSERT_EQUAL_UINT32(evFirst[1][EV_PRESS], evFirst[2][EV_PRESS]);
+    TEST_ASSERT_EQUAL_UINT32(evFirst[1][EV_LONG],  evFirst[2][EV_LONG]);
+    for(uint8_t p = 3; p <= NBTN; p++) TEST_ASSERT_EQUAL_UINT8(0, evCnt[p][EV_PRESS]);
+}
+
+// Short presses on all buttons, then bounces shorter than the debounce time
+void test_short_and_bounce(void)
+{
+    for(uint8_t p = 1; p <= NBTN; p++) setPin(p, true);
+    run(100);
+    for(uint8_t p = 1; p <= NBTN; p++) setPin(p, false);
+    run(100);
+    for(uint8_t i = 0; i < 5; i++) {
+        setPin(5, true);
+        setPin(6, true);
+        run(4);
+        setPin(5, false);
+        setPin(6, false);
+        run(4);
+    }
+    run(100);
+    for(uint8_t p = 1; p <= NBTN; p++) {
+        TEST_ASSERT_EQUAL_UINT8(1, evCnt[p][EV_PRESS]);
+        TEST_ASSERT_EQUAL_UINT8(1, evCnt[p][EV_RELEASE]);
+        TEST_ASSERT_EQUAL_UINT8(0, evCnt[p][EV_LONG]);
+        TEST_ASSERT_EQUAL_UINT32(evFirst[1][EV_PRESS],   evFirst[p][EV_PRESS]);
+        TEST_ASSERT_EQUAL_UINT32(evFirst[1][EV_RELEASE], evFirst[p][EV_RELEASE]);
+    }
+}
+
+// The mode under test is actually the one compiled
+void test_dispatch_mode(void)
+{
+#ifdef BTN_DEVIRT
+    TEST_ASSERT_FALSE(std::is_polymorphic<ButtonEvt>::value);
+    TEST_ASSERT_FALSE(std::is_polymorphic<ButtonAdv>::value);
+#else
+    TEST_ASSERT_TRUE(std::is_polymorphic<ButtonEvt>::value);
+    TEST_ASSERT_TRUE(std::is_polymorphic<ButtonAdv>::value);
+#endif
+}
+
+static int runScenario(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_hold);
+    RUN_TEST(test_short_and_bounce);
+    RUN_TEST(test_dispatch_mode);
+    return UNITY_END();
+}
+
+#endif // BTNSCENARIO_H
@@ -0,0 +1,19 @@
+// =======================================================================
+// @file        test_main.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Host tests for the devirtualized button dispatch (BTN_DEVIRT)
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+// Must precede all the button headers
+#define BTN_DEVIRT
+
+#include "btnScenario.h"
+
+int main(int argc, char **argv)
+{
+    return runScenario();
+}
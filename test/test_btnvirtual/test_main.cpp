@@ -0,0 +1,16 @@
+// =======================================================================
+// @file        test_main.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Host tests for the button dispatch with virtual methods
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include "btnScenario.h"
+
+int main(int argc, char **argv)
+{
+    return runScenario();
+}
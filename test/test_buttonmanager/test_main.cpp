@@ -0,0 +1,267 @@
+// =======================================================================
+// @file        test_main.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Host tests for the ButtonManager per-input timing engine and flag plane layouts
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include <unity.h>
+#include "ButtonManager.h"
+
+// The libraries are not built for the native env (see platformio.ini): pull in their sources
+#include "FrameClock.cpp"
+#include "CtlTable.cpp"
+
+// Simulated time (ms)
+static uint32_t simMs;
+static uint32_t simClock(void)  { return simMs; }
+
+// Events received through the descriptor table callback
+struct Ev {
+    uint16_t    tag;
+    uint8_t     event;
+};
+static Ev       evLog[64];
+static uint8_t  nEv;
+
+static void onEvent(uint16_t tag, uint8_t event, int8_t delta)
+{
+    (void)delta;
+    if(nEv < 64) evLog[nEv++] = Ev{ tag, event };
+}
+static const CTLcallback CALLBACKS[] = { onEvent };
+
+static uint8_t count(uint16_t tag, uint8_t event)
+{
+    uint8_t n = 0;
+    for(uint8_t i = 0; i < nEv; i++) if(evLog[i].tag == tag && evLog[i].event == event) n++;
+    return n;
+}
+
+//    tag   cb  pin     type        lp  rptDly  rptRate
+// Ten toggle switches (no long press, no repeat), then pushbuttons
+static const BtnDesc TABLE[] PROGMEM = {
+    { 1,    0,  1,      CT_SWITCH,  0,  0,      0 },
+    { 2,    0,  2,      CT_SWITCH,  0,  0,      0 },
+    { 3,    0,  3,      CT_SWITCH,  0,  0,      0 },
+    { 4,    0,  4,      CT_SWITCH,  0,  0,      0 },
+    { 5,    0,  5,      CT_SWITCH,  0,  0,      0 },
+    { 6,    0,  6,      CT_SWITCH,  0,  0,      0 },
+    { 7,    0,  7,      CT_SWITCH,  0,  0,      0 },
+    { 8,    0,  8,      CT_SWITCH,  0,  0,      0 },
+    { 9,    0,  9,      CT_SWITCH,  0,  0,      0 },
+    { 10,   0,  10,     CT_SWITCH,  0,  0,      0 },
+    { 20,   0,  20,     CT_PUSH,    10, 0,      0 },    // Long press at 1s, no repeat
+    { 21,   0,  21,     CT_PUSH,    0,  5,      20 },   // Repeat after 500ms, every 200ms
+};
+static const uint8_t NROWS = sizeof(TABLE)/sizeof(TABLE[0]);
+
+static ButtonManager<64>    *mgr;
+static uint8_t              vec[8];
+
+static void setPin(uint8_t pin, bool on)
+{
+    uint8_t b = pin-1;
+    if(on) vec[b>>3] |= (1 << (b&7)); else vec[b>>3] &= ~(1 << (b&7));
+}
+
+// Run passes every <step> ms for <ms> ms
+static void run(uint16_t ms, uint8_t step = 2)
+{
+    for(uint16_t t = 0; t < ms; t += step) {
+        simMs += step;
+        FrameClock::latch();
+        mgr->checkButtons(vec);
+    }
+}
+
+void setUp(void)
+{
+    static uint8_t mem[sizeof(ButtonManager<64>)];
+    simMs = 1000;
+    FrameClock::setSource(simClock);
+    memset(vec, 0, sizeof(vec));
+    mgr = new (mem) ButtonManager<64>();
+    CtlTable::setCallbacks(CALLBACKS, 1);
+    mgr->setTable(TABLE, NROWS);
+    mgr->initButtons(vec);
+    nEv = 0;
+}
+
+void tearDown(void) {}
+
+// Switches left ON do not keep their active entries: more switches than entries can be
+// turned on, and later changes are still seen
+void test_switches_left_on(void)
+{
+    for(uint8_t p = 1; p <= 10; p++) setPin(p, true);
+    run(100);
+    for(uint8_t t = 1; t <= 10; t++) TEST_ASSERT_EQUAL_UINT8(1, count(t, IEV_PRESS));
+    // Two switches had to wait for a free entry: each is counted once
+    TEST_ASSERT_EQUAL_UINT16(2, mgr->getActiveOverflows());
+    TEST_ASSERT_FALSE(mgr->busy());
+
+    // A pushbutton pressed while all switches are ON
+    setPin(21, true);
+    run(100);
+    TEST_ASSERT_EQUAL_UINT8(1, count(21, IEV_PRESS));
+    setPin(21, false);
+    setPin(3, false);
+    run(100);
+    TEST_ASSERT_EQUAL_UINT8(1, count(21, IEV_RELEASE));
+    TEST_ASSERT_EQUAL_UINT8(1, count(3, IEV_RELEASE));
+    TEST_ASSERT_EQUAL_UINT8(0, count(3, IEV_LONG));
+    TEST_ASSERT_FALSE(mgr->busy());
+    TEST_ASSERT_EQUAL_UINT16(2, mgr->getActiveOverflows());
+}
+
+// A held input stays timed only until its long press has been signalled
+void test_long_press_then_idle(void)
+{
+    setPin(20, true);
+    run(500);
+    TEST_ASSERT_EQUAL_UINT8(1, count(20, IEV_PRESS));
+    TEST_ASSERT_TRUE(mgr->busy());
+    run(1000);
+    TEST_ASSERT_EQUAL_UINT8(1, count(20, IEV_LONG));
+    TEST_ASSERT_FALSE(mgr->busy());
+    run(3000);
+    TEST_ASSERT_EQUAL_UINT8(1, count(20, IEV_LONG));
+    setPin(20, false);
+    run(100);
+    TEST_ASSERT_EQUAL_UINT8(1, count(20, IEV_RELEASE));
+    TEST_ASSERT_EQUAL_UINT8(1, count(20, IEV_LONG));
+    TEST_ASSERT_FALSE(mgr->busy());
+}
+
+// A release which bounces back does not bring back the long press
+void test_release_bounce_after_idle(void)
+{
+    setPin(20, true);
+    run(1500);
+    TEST_ASSERT_EQUAL_UINT8(1, count(20, IEV_LONG));
+    setPin(20, false);
+    run(4);
+    setPin(20, true);
+    run(2000);
+    TEST_ASSERT_EQUAL_UINT8(0, count(20, IEV_RELEASE));
+    TEST_ASSERT_EQUAL_UINT8(1, count(20, IEV_LONG));
+    TEST_ASSERT_FALSE(mgr->busy());
+}
+
+// Repeat keeps the input timed for as long as it is held
+void test_repeat(void)
+{
+    setPin(21, true);
+    run(1000);
+    TEST_ASSERT_EQUAL_UINT8(1, count(21, IEV_PRESS));
+    // First repeat at 500ms, then every 200ms
+    TEST_ASSERT_EQUAL_UINT8(3, count(21, IEV_REPEAT));
+    TEST_ASSERT_TRUE(mgr->busy());
+    setPin(21, false);
+    run(100);
+    TEST_ASSERT_EQUAL_UINT8(1, count(21, IEV_RELEASE));
+    TEST_ASSERT_FALSE(mgr->busy());
+}
+
+// ---- Flag plane layouts ----
+// The same input sequence, replayed through the 8-bit and the 64-bit word layouts,
+// must produce the same events at the same times
+
+// Rows spread across the whole vector, on byte and word boundaries
+static const BtnDesc SPREAD[] PROGMEM = {
+    { 101,  0,  1,      CT_PUSH,    10, 0,      0 },
+    { 108,  0,  8,      CT_SWITCH,  0,  0,      0 },
+    { 109,  0,  9,      CT_PUSH,    0,  5,      20 },
+    { 116,  0,  16,     CT_PUSH,    5,  0,      0 },
+    { 117,  0,  17,     CT_SWITCH,  0,  0,      0 },
+    { 132,  0,  32,     CT_PUSH,    0,  3,      10 },
+    { 133,  0,  33,     CT_PUSH,    10, 0,      0 },
+    { 140,  0,  40,     CT_SWITCH,  0,  0,      0 },
+    { 141,  0,  41,     CT_PUSH,    8,  4,      5 },
+    { 156,  0,  56,     CT_PUSH,    0,  0,      0 },
+    { 163,  0,  63,     CT_PUSH,    10, 0,      0 },
+    { 164,  0,  64,     CT_PUSH,    0,  2,      10 },
+};
+static const uint8_t NSPREAD = sizeof(SPREAD)/sizeof(SPREAD[0]);
+
+struct TEv {
+    uint32_t    t;
+    uint16_t    tag;
+    uint8_t     event;
+};
+static const uint16_t MAXTEV = 2048;
+static TEv      *tLog;
+static uint16_t nTEv;
+
+static void onTimedEvent(uint16_t tag, uint8_t event, int8_t delta)
+{
+    (void)delta;
+    if(nTEv < MAXTEV) tLog[nTEv++] = TEv{ simMs, tag, event };
+}
+static const CTLcallback TIMED_CALLBACKS[] = { onTimedEvent };
+
+// Replay a pseudo-random input sequence (presses, releases and bounces) for <ms> ms
+template<typename W>
+static uint16_t replay(TEv *log, uint32_t ms, uint16_t &ovf)
+{
+    static uint8_t mem[sizeof(ButtonManager<64, W>)];
+    uint32_t rnd = 12345;
+
+    simMs = 1000;
+    FrameClock::latch();
+    memset(vec, 0, sizeof(vec));
+    ButtonManager<64, W> *m = new (mem) ButtonManager<64, W>();
+    CtlTable::setCallbacks(TIMED_CALLBACKS, 1);
+    tLog = log;
+    nTEv = 0;
+    m->setTable(SPREAD, NSPREAD);
+    m->initButtons(vec);
+    for(uint32_t t = 0; t < ms; t += 2) {
+        rnd = rnd * 1103515245UL + 12345UL;
+        if(((rnd >> 16) & 0x0F) == 0) {
+            uint8_t pin = pgm_read_byte(&SPREAD[(rnd >> 20) % NSPREAD].pin);
+            uint8_t b = pin-1;
+            vec[b>>3] ^= (1 << (b&7));
+        }
+        simMs += 2;
+        FrameClock::latch();
+        m->checkButtons(vec);
+    }
+    ovf = m->getActiveOverflows();
+    return nTEv;
+}
+
+void test_layouts_match(void)
+{
+    static TEv log8[MAXTEV], log64[MAXTEV];
+    uint16_t ovf8, ovf64;
+    uint16_t n8  = replay<uint8_t>(log8, 20000, ovf8);
+    uint16_t n64 = replay<uint64_t>(log64, 20000, ovf64);
+
+    // The sequence must be long enough to be meaningful (active set overflows included), and fit the log
+    TEST_ASSERT_GREATER_THAN(200, n8);
+    TEST_ASSERT_LESS_THAN(MAXTEV, n8);
+    TEST_ASSERT_GREATER_THAN(0, ovf8);
+    TEST_ASSERT_EQUAL_UINT16(n8, n64);
+    TEST_ASSERT_EQUAL_UINT16(ovf8, ovf64);
+    for(uint16_t i = 0; i < n8; i++) {
+        TEST_ASSERT_EQUAL_UINT32(log8[i].t, log64[i].t);
+        TEST_ASSERT_EQUAL_UINT16(log8[i].tag, log64[i].tag);
+        TEST_ASSERT_EQUAL_UINT8(log8[i].event, log64[i].event);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_switches_left_on);
+    RUN_TEST(test_long_press_then_idle);
+    RUN_TEST(test_release_bounce_after_idle);
+    RUN_TEST(test_repeat);
+    RUN_TEST(test_layouts_match);
+    return UNITY_END();
+}
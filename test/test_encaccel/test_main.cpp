@@ -0,0 +1,175 @@
+// =======================================================================
+// @file        test_main.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Host tests for the encoder acceleration profiles (EncAccel),
+//              replaying spin traces through EncoderSet
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include <unity.h>
+#include "EncoderSet.h"
+
+// The libraries are not built for the native env (see platformio.ini): pull in their sources
+#include "FrameClock.cpp"
+#include "EncAccel.cpp"
+
+/// Spin traces: intervals (ms) between consecutive steps, as logged from a panel knob.
+/// 0 stands for a pause long enough to make the encoder idle; positive/negative entries
+/// are steps up/down.
+static const int16_t TRACE_TUNE[] = {       // Detent by detent (e.g. radio frequency)
+    0, 180, 150, 210, 170, 160, 190, 140, 200, 175,
+};
+static const int16_t TRACE_FLICK[] = {      // A single flick: speeds up, then coasts
+    0, 30, 18, 12, 9, 7, 5, 4, 3, 3, 3, 4, 4, 5, 6, 8, 11, 15, 22, 35, 60,
+};
+static const int16_t TRACE_BACK[] = {       // Fast spin up, overshoot, fast correction down
+    0, 3, 3, 3, 3, 3, 3, 3, -3, -3, -3, -3, -3,
+};
+
+struct Trace {
+    const int16_t   *iv;
+    uint8_t         n;
+};
+static const Trace TRACES[] = {
+    { TRACE_TUNE,  sizeof(TRACE_TUNE)/sizeof(TRACE_TUNE[0]) },
+    { TRACE_FLICK, sizeof(TRACE_FLICK)/sizeof(TRACE_FLICK[0]) },
+    { TRACE_BACK,  sizeof(TRACE_BACK)/sizeof(TRACE_BACK[0]) },
+};
+
+/// Replay helper: edge decoder on encoder 1; each step raises line A (B gives the direction)
+/// and releases it 1 ms later.
+struct Spinner {
+    EncoderSet  enc;
+    uint16_t    t;
+
+    explicit Spinner(uint8_t profile) : enc(1), t(1)
+    {
+        enc.setAccel(1, profile);
+    }
+
+    /// Perform one step <iv> ms after the previous one; return the counts it added
+    int step(int16_t iv)
+    {
+        bool up = (iv >= 0);
+        t += (iv == 0 ? 1000 : (iv < 0 ? -iv : iv));
+        enc.update((uint32_t)(up ? 0x01 : 0x03), t);
+        enc.update((uint32_t)(up ? 0x00 : 0x02), (uint16_t)(t+1));
+        return enc.getEncCount(1, 1);
+    }
+
+    int replay(const Trace &tr)
+    {
+        int sum = 0;
+        for(uint8_t i = 0; i < tr.n; i++) sum += step(tr.iv[i]);
+        return sum;
+    }
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_profile_tables(void)
+{
+    // Below the first breakpoint of each profile, and past the last one
+    TEST_ASSERT_EQUAL_UINT8(STEP_VERYFAST, EncAccel::mult(EncAccel::ACC_DEFAULT, 2));
+    TEST_ASSERT_EQUAL_UINT8(1,  EncAccel::mult(EncAccel::ACC_DEFAULT, THR_FAST));
+    TEST_ASSERT_EQUAL_UINT8(1,  EncAccel::mult(EncAccel::ACC_NONE, 0));
+    TEST_ASSERT_EQUAL_UINT8(4,  EncAccel::mult(EncAccel::ACC_FINE, 7));
+    TEST_ASSERT_EQUAL_UINT8(2,  EncAccel::mult(EncAccel::ACC_FINE, 8));
+    TEST_ASSERT_EQUAL_UINT8(1,  EncAccel::mult(EncAccel::ACC_FINE, 16));
+    TEST_ASSERT_EQUAL_UINT8(10, EncAccel::mult(EncAccel::ACC_MEDIUM, 5));
+    TEST_ASSERT_EQUAL_UINT8(2,  EncAccel::mult(EncAccel::ACC_MEDIUM, 24));
+    TEST_ASSERT_EQUAL_UINT8(20, EncAccel::mult(EncAccel::ACC_COARSE, 0));
+    TEST_ASSERT_EQUAL_UINT8(2,  EncAccel::mult(EncAccel::ACC_COARSE, 39));
+    TEST_ASSERT_EQUAL_UINT8(1,  EncAccel::mult(EncAccel::ACC_COARSE, EncAccel::ACC_IDLE));
+    // Unknown profiles fall back to the default
+    TEST_ASSERT_EQUAL_UINT8(STEP_VERYFAST, EncAccel::mult(EncAccel::N_PROFILES, 2));
+}
+
+// Multipliers grow monotonically with speed, for every profile
+void test_profiles_monotonic(void)
+{
+    for(uint8_t p = 0; p < EncAccel::N_PROFILES; p++) {
+        uint8_t prev = EncAccel::mult(p, 0);
+        for(uint16_t iv = 1; iv <= EncAccel::ACC_IDLE; iv++) {
+            uint8_t m = EncAccel::mult(p, (uint8_t)iv);
+            TEST_ASSERT_TRUE(m <= prev);
+            prev = m;
+        }
+        TEST_ASSERT_EQUAL_UINT8(1, prev);
+    }
+}
+
+// Net counts of each trace, per profile
+void test_replay_traces(void)
+{
+    static const int expected[EncAccel::N_PROFILES][3] = {
+        //  TUNE   FLICK  BACK
+        {   10,    49,    11 },     // ACC_DEFAULT
+        {   10,    21,     3 },     // ACC_NONE
+        {   10,    55,     9 },     // ACC_FINE
+        {   10,   116,    21 },     // ACC_MEDIUM
+        {   10,   228,    41 },     // ACC_COARSE
+    };
+    for(uint8_t p = 0; p < EncAccel::N_PROFILES; p++) {
+        for(uint8_t k = 0; k < 3; k++) {
+            Spinner s(p);
+            TEST_ASSERT_EQUAL_INT(expected[p][k], s.replay(TRACES[k]));
+        }
+    }
+}
+
+// ACC_DEFAULT averages the last 4 step intervals, and the interval of the first step after
+// a pause is saturated: however fast the spin, the first steps after idle count 1 each
+void test_default_first_steps_after_idle(void)
+{
+    Spinner s(EncAccel::ACC_DEFAULT);
+    TEST_ASSERT_EQUAL_INT(1, s.step(0));
+    for(uint8_t i = 0; i < 3; i++) TEST_ASSERT_EQUAL_INT(1, s.step(2));
+    TEST_ASSERT_EQUAL_INT(STEP_VERYFAST, s.step(2));
+    // Same after a pause
+    TEST_ASSERT_EQUAL_INT(1, s.step(0));
+    for(uint8_t i = 0; i < 3; i++) TEST_ASSERT_EQUAL_INT(1, s.step(2));
+    TEST_ASSERT_EQUAL_INT(STEP_VERYFAST, s.step(2));
+}
+
+// Reversing restarts the speed history: turning back is never accelerated by the previous spin
+void test_reverse_restarts_history(void)
+{
+    Spinner s(EncAccel::ACC_COARSE);
+    s.step(0);
+    for(uint8_t i = 0; i < 6; i++) s.step(3);
+    TEST_ASSERT_EQUAL_INT(20, s.step(3));
+    TEST_ASSERT_EQUAL_INT(-1, s.step(-3));
+}
+
+// Each encoder has its own profile and history
+void test_per_encoder_profiles(void)
+{
+    EncoderSet es(2);
+    es.setAccel(1, EncAccel::ACC_NONE);
+    es.setAccel(2, EncAccel::ACC_COARSE);
+    uint16_t t = 1;
+    for(uint8_t i = 0; i < 8; i++) {
+        t += 3;
+        es.update((uint32_t)0x09, t);     // A of both encoders rises, B low: both up
+        es.update((uint32_t)0x00, (uint16_t)(t+1));
+    }
+    TEST_ASSERT_EQUAL_INT(8, es.getEncCount(1, 1));
+    TEST_ASSERT_TRUE(es.getEncCount(2, 1) > 8);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_profile_tables);
+    RUN_TEST(test_profiles_monotonic);
+    RUN_TEST(test_replay_traces);
+    RUN_TEST(test_default_first_steps_after_idle);
+    RUN_TEST(test_reverse_restarts_history);
+    RUN_TEST(test_per_encoder_profiles);
+    return UNITY_END();
+}
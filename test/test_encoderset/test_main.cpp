@@ -0,0 +1,180 @@
+// =======================================================================
+// @file        test_main.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Host tests for the EncoderSet decoders (timestamped samples)
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include <unity.h>
+#include "EncoderSet.h"
+
+// The libraries are not built for the native env (see platformio.ini): pull in their sources
+#include "FrameClock.cpp"
+#include "EncAccel.cpp"
+
+// Quadrature sequence (A, B) for one full cycle upwards (A leads B); downwards is the reverse
+static const uint8_t CYCLE_UP[4] = { 0x01, 0x03, 0x02, 0x00 };
+static const uint8_t CYCLE_DN[4] = { 0x02, 0x03, 0x01, 0x00 };
+
+/// Simulated encoder lines: keeps the input vector and the sample time for an EncoderSet
+template<class ES>
+struct Rig {
+    ES          &enc;
+    uint64_t    vec;
+    uint16_t    t;
+
+    Rig(ES &e, uint16_t t0) : enc(e), vec(0), t(t0) {}
+
+    /// Set the A/B lines of encoder <n> (0-based) to <ab> and sample <dt> ms after the previous sample
+    void set(uint8_t n, uint8_t ab, uint16_t dt)
+    {
+        vec = (vec & ~((uint64_t)3 << (3*n))) | ((uint64_t)ab << (3*n));
+        t += dt;
+        enc.update(vec, t);
+    }
+
+    /// Turn encoder <n> by <cycles> full cycles, one transition every <dt> ms
+    void turn(uint8_t n, int cycles, uint16_t dt)
+    {
+        const uint8_t *seq = (cycles > 0 ? CYCLE_UP : CYCLE_DN);
+        for(int c = (cycles > 0 ? cycles : -cycles); c > 0; c--) {
+            for(uint8_t k = 0; k < 4; k++) set(n, seq[k], dt);
+        }
+    }
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_edge_decoder_counts_cycles(void)
+{
+    EncoderSet es(2);
+    Rig<EncoderSet> r(es, 1);
+    r.turn(0, 5, 20);
+    TEST_ASSERT_TRUE(es.getEncChangeUp(1) != 0);
+    TEST_ASSERT_EQUAL_INT(5, es.getEncCount(1, 1));
+    TEST_ASSERT_EQUAL_INT(0, es.getEncCount(1, 1));
+    r.turn(0, -3, 20);
+    TEST_ASSERT_TRUE(es.getEncChangeDn(1) != 0);
+    TEST_ASSERT_EQUAL_INT(-3, es.getEncCount(1, 1));
+    // The other encoder has not moved
+    TEST_ASSERT_EQUAL_INT(0, es.getEncCount(2, 1));
+}
+
+void test_quadrature_resolution(void)
+{
+    EncoderSet es(3);
+    es.setDecoder(1, EncoderSet::DEC_FULL);
+    es.setDecoder(2, EncoderSet::DEC_HALF);
+    es.setDecoder(3, EncoderSet::DEC_QUARTER);
+    es.setAccel(0, EncAccel::ACC_NONE);
+    Rig<EncoderSet> r(es, 1);
+    // All three encoders driven by the same lines, in the same samples
+    for(uint8_t c = 0; c < 3; c++) {
+        for(uint8_t k = 0; k < 4; k++) {
+            r.vec = (uint64_t)CYCLE_UP[k] * 0x49;     // Same A/B on encoders 1..3
+            r.t += 20;
+            es.update(r.vec, r.t);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(3, es.getEncCount(1, 1));
+    TEST_ASSERT_EQUAL_INT(6, es.getEncCount(2, 1));
+    TEST_ASSERT_EQUAL_INT(12, es.getEncCount(3, 1));
+    r.turn(0, -2, 20);
+    TEST_ASSERT_EQUAL_INT(-2, es.getEncCount(1, 1));
+    TEST_ASSERT_EQUAL_INT(0, es.getIllegal(1));
+}
+
+void test_quadrature_rejects_illegal(void)
+{
+    EncoderSet es(1);
+    es.setDecoder(1, EncoderSet::DEC_FULL);
+    Rig<EncoderSet> r(es, 1);
+    r.set(0, 0x03, 20);     // Both lines changed in one sample: a transition was missed
+    r.set(0, 0x00, 20);
+    TEST_ASSERT_EQUAL_UINT8(2, es.getIllegal(1));
+    TEST_ASSERT_EQUAL_INT(0, es.getEncCount(1, 1));
+    // Position is known again at the detent: the next cycle counts normally
+    r.turn(0, 1, 20);
+    TEST_ASSERT_EQUAL_INT(1, es.getEncCount(1, 1));
+}
+
+// Sample times are 16-bit: steps across the wrap-around must look as slow as the others
+void test_timestamp_wraparound(void)
+{
+    EncoderSet es(1);
+    Rig<EncoderSet> r(es, 65500);
+    r.turn(0, 10, 20);
+    TEST_ASSERT_TRUE(r.t < 65500);
+    TEST_ASSERT_EQUAL_INT(10, es.getEncCount(1, 1));
+    TEST_ASSERT_EQUAL(0, es.getEncChangeQUp());
+}
+
+// Repeated samples with the same timestamp are ignored
+void test_same_timestamp_ignored(void)
+{
+    EncoderSet es(1);
+    Rig<EncoderSet> r(es, 1);
+    r.set(0, 0x01, 20);
+    r.set(0, 0x00, 0);
+    r.set(0, 0x01, 0);
+    TEST_ASSERT_EQUAL_INT(1, es.getEncCount(1, 1));
+}
+
+// Several boards (one EncoderSet each) sampled in the same frames, in interleaved order:
+// each instance must decode from its own history. Board 2 is shifted by half a cycle, so that
+// its lines never match those of board 1 in the same frame.
+void test_multiboard_interleaved(void)
+{
+    static const uint8_t NB = 4;
+    EncoderSet es[NB];
+    uint64_t vec[NB] = {0};
+    uint16_t t = 1;
+    for(uint8_t b = 0; b < NB; b++) es[b].init(6);
+    es[3].setDecoder(0, EncoderSet::DEC_QUARTER);
+
+    for(uint16_t f = 0; f < 4*25; f++) {
+        uint8_t k = f & 3;
+        // Board 0: enc 1 up
+        vec[0] = CYCLE_UP[k];
+        // Board 1: enc 1 down, enc 6 up (two cycles in a row, then one at rest)
+        vec[1] = CYCLE_DN[k] | ((f % 12) < 8 ? ((uint64_t)CYCLE_UP[k] << 15) : 0);
+        // Board 2: enc 2 up, half a cycle behind board 0
+        vec[2] = ((uint64_t)CYCLE_UP[(k+2)&3] << 3);
+        // Board 3: all encoders up (quarter decoder), button of enc 4 held
+        vec[3] = ((uint64_t)CYCLE_UP[k] * 0x9249249ULL) | ((uint64_t)1 << 11);
+        t += 20;
+        for(uint8_t i = 0; i < NB; i++) {
+            uint8_t b = (uint8_t)((i + f) % NB);    // Rotate the update order
+            es[b].update(vec[b], t);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(25,  es[0].getEncCount(1, 1));
+    for(uint8_t n = 2; n <= 6; n++) TEST_ASSERT_EQUAL_INT(0, es[0].getEncCount(n, 1));
+
+    TEST_ASSERT_EQUAL_INT(-25, es[1].getEncCount(1, 1));
+    TEST_ASSERT_EQUAL_INT(17,  es[1].getEncCount(6, 1));
+
+    // Board 2 starts mid-cycle: its first rising edge of A is in frame 2
+    TEST_ASSERT_EQUAL_INT(25,  es[2].getEncCount(2, 1));
+    TEST_ASSERT_EQUAL_INT(0,   es[2].getEncCount(1, 1));
+
+    for(uint8_t n = 1; n <= 6; n++) TEST_ASSERT_EQUAL_INT(100, es[3].getEncCount(n, 1));
+    TEST_ASSERT_EQUAL(0x08, es[3].getBtns()->current);
+    for(uint8_t b = 0; b < 3; b++) TEST_ASSERT_EQUAL(0, es[b].getBtns()->current);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_edge_decoder_counts_cycles);
+    RUN_TEST(test_quadrature_resolution);
+    RUN_TEST(test_quadrature_rejects_illegal);
+    RUN_TEST(test_timestamp_wraparound);
+    RUN_TEST(test_same_timestamp_ignored);
+    RUN_TEST(test_multiboard_interleaved);
+    return UNITY_END();
+}
@@ -0,0 +1,100 @@
+// =======================================================================
+// @file        test_main.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Host tests for the SPI transaction setups of a scan frame
+//              on the MCP23S17 expanders, with and without a bus session
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include <unity.h>
+#include "MCP23S17.h"
+
+// The libraries are not built for the native env (see platformio.ini): pull in their sources
+#include "MCP23x17.cpp"
+#include "MCP23S17.cpp"
+
+// Three boards with two expanders each, as scanned by one frame of ScanScheduler
+static const uint8_t NCHIPS = 6;
+static MCPS     chip[NCHIPS];
+static uint16_t outVal;
+
+// What ScanInOut() does for each expander: outputs written, then inputs read
+// (alternately a full read, and the INTF..GPIO burst of the change-notification mode)
+static void scanFrame(void)
+{
+    unsigned int icap, gpio;
+    outVal++;
+    for(uint8_t c = 0; c < NCHIPS; c++) {
+        chip[c].IOWrite(outVal);
+        if(c & 1) chip[c].getIntState(icap, gpio); else chip[c].IORead();
+    }
+}
+
+void setUp(void)
+{
+    for(uint8_t c = 0; c < NCHIPS; c++) {
+        chip[c].config(c & 0x07, 10+c);
+        chip[c].begin();
+    }
+    outVal = 0;
+    SPI.clear();
+    MCPS::clearTxSetups();
+}
+
+void tearDown(void) {}
+
+// Without a session, every register operation sets up its own transaction
+void test_frame_without_session(void)
+{
+    scanFrame();
+    TEST_ASSERT_EQUAL_UINT16(2*NCHIPS, MCPS::getTxSetups());
+    TEST_ASSERT_EQUAL_UINT16(2*NCHIPS, SPI.transactions);
+    TEST_ASSERT_EQUAL_UINT16(0, SPI.nested);
+    TEST_ASSERT_EQUAL_UINT16(0, SPI.outside);
+    TEST_ASSERT_FALSE(MCPS::busBusy());
+}
+
+// Within a session, the whole frame costs a single setup, for the same bytes on the bus
+void test_frame_with_session(void)
+{
+    scanFrame();
+    uint16_t bytes = SPI.transfers;
+    SPI.clear();
+    MCPS::clearTxSetups();
+
+    MCPS::busBegin();
+    TEST_ASSERT_TRUE(MCPS::busBusy());
+    scanFrame();
+    MCPS::busEnd();
+    TEST_ASSERT_EQUAL_UINT16(1, MCPS::getTxSetups());
+    TEST_ASSERT_EQUAL_UINT16(1, SPI.transactions);
+    TEST_ASSERT_EQUAL_UINT16(bytes, SPI.transfers);
+    TEST_ASSERT_EQUAL_UINT16(0, SPI.nested);
+    TEST_ASSERT_EQUAL_UINT16(0, SPI.outside);
+    TEST_ASSERT_FALSE(MCPS::busBusy());
+}
+
+// Sessions do not nest: a second busBegin() is ignored, as is a busEnd() without a session
+void test_session_no_nesting(void)
+{
+    MCPS::busBegin();
+    MCPS::busBegin();
+    scanFrame();
+    MCPS::busEnd();
+    MCPS::busEnd();
+    TEST_ASSERT_EQUAL_UINT16(1, MCPS::getTxSetups());
+    TEST_ASSERT_EQUAL_UINT16(0, SPI.nested);
+    TEST_ASSERT_FALSE(SPI.open);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_without_session);
+    RUN_TEST(test_frame_with_session);
+    RUN_TEST(test_session_no_nesting);
+    return UNITY_END();
+}
@@ -0,0 +1,87 @@
+// =======================================================================
+// @file        test_main.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Host tests for SPSCRing (encoder sample hand-off, see EncSampler)
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include <unity.h>
+#include "spscRing.h"
+
+struct Sample {
+    uint32_t    vec;
+    uint16_t    tick;
+    uint8_t     slot;
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_fifo_order(void)
+{
+    SPSCRing<Sample, 4> q;
+    Sample s;
+    TEST_ASSERT_TRUE(q.empty());
+    TEST_ASSERT_FALSE(q.pop(s));
+    for(uint8_t i = 0; i < 3; i++) TEST_ASSERT_TRUE(q.push(Sample{100u + i, (uint16_t)(10*i), i}));
+    TEST_ASSERT_EQUAL_UINT8(3, q.count());
+    for(uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(q.pop(s));
+        TEST_ASSERT_EQUAL_UINT32(100u + i, s.vec);
+        TEST_ASSERT_EQUAL_UINT16(10*i, s.tick);
+        TEST_ASSERT_EQUAL_UINT8(i, s.slot);
+    }
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+void test_full_buffer_drops_and_counts(void)
+{
+    SPSCRing<Sample, 4> q;
+    Sample s;
+    for(uint8_t i = 0; i < 4; i++) TEST_ASSERT_TRUE(q.push(Sample{i, 0, 0}));
+    // No slot is wasted: the fifth element is rejected
+    TEST_ASSERT_FALSE(q.push(Sample{99, 0, 0}));
+    TEST_ASSERT_EQUAL_UINT16(1, q.overflows());
+    TEST_ASSERT_EQUAL_UINT8(4, q.highWater());
+    // The rejected element never shows up; the queued ones are intact
+    for(uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(q.pop(s));
+        TEST_ASSERT_EQUAL_UINT32(i, s.vec);
+    }
+    TEST_ASSERT_FALSE(q.pop(s));
+    // Room again after draining
+    TEST_ASSERT_TRUE(q.push(Sample{5, 0, 0}));
+    q.clearStats();
+    TEST_ASSERT_EQUAL_UINT16(0, q.overflows());
+    TEST_ASSERT_EQUAL_UINT8(0, q.highWater());
+}
+
+// The indexes are free-running 8-bit counters: run them past their wrap-around
+// with the buffer at various fill levels
+void test_index_wraparound(void)
+{
+    SPSCRing<Sample, 8> q;
+    Sample s;
+    uint32_t in = 0, out = 0;
+    for(uint16_t round = 0; round < 1000; round++) {
+        uint8_t n = (uint8_t)(1 + round % 8);
+        for(uint8_t i = 0; i < n; i++) TEST_ASSERT_TRUE(q.push(Sample{in++, 0, 0}));
+        TEST_ASSERT_EQUAL_UINT8(n, q.count());
+        while(q.pop(s)) TEST_ASSERT_EQUAL_UINT32(out++, s.vec);
+    }
+    TEST_ASSERT_EQUAL_UINT32(in, out);
+    TEST_ASSERT_EQUAL_UINT16(0, q.overflows());
+    TEST_ASSERT_EQUAL_UINT8(8, q.highWater());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_full_buffer_drops_and_counts);
+    RUN_TEST(test_index_wraparound);
+    return UNITY_END();
+}
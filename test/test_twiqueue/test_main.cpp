@@ -0,0 +1,165 @@
+// =======================================================================
+// @file        test_main.cpp
+//
+// @project     M10_Mobiflight
+//
+// @details     Host tests for the TWI transaction queue (TWIQueue),
+//              run against the simulated TWI peripheral (TWIsim)
+//
+// Copyright (c) 2023 GiorgioCC
+// =======================================================================
+
+#include <unity.h>
+#include "TWIQueue.h"
+
+// The libraries are not built for the native env (see platformio.ini): pull in their sources
+#include "TWIQueue.cpp"
+
+static TWIsim &bus = twiSim();
+
+void setUp(void)
+{
+    bus.reset();
+    TWIQueue::begin(400000UL);
+}
+
+void tearDown(void) {}
+
+void test_begin_400kHz(void)
+{
+    // SCL = F_CPU / (16 + 2*TWBR)
+    TEST_ASSERT_EQUAL_UINT8(12, TWBR);
+    TEST_ASSERT_TRUE(TWIQueue::idle());
+}
+
+void test_write(void)
+{
+    uint8_t out[2] = { 0xA5, 0x3C };
+    TWItx tx;
+    TEST_ASSERT_TRUE(TWIQueue::submit(&tx, 0x20, 0x14, out, 2, false));
+    TEST_ASSERT_EQUAL_UINT8(TWI_PENDING, tx.status);
+    bus.run();
+    TEST_ASSERT_EQUAL_UINT8(TWI_DONE, tx.status);
+    TEST_ASSERT_EQUAL_STRING("S A20W 14 A5 3C P", bus.log.c_str());
+    TEST_ASSERT_EQUAL_HEX8(0xA5, bus.regs[0x14]);
+    TEST_ASSERT_EQUAL_HEX8(0x3C, bus.regs[0x15]);
+    TEST_ASSERT_TRUE(TWIQueue::idle());
+    TEST_ASSERT_FALSE(bus.busy());
+}
+
+void test_read_repeated_start(void)
+{
+    uint8_t in[3] = { 0 };
+    TWItx tx;
+    bus.regs[0x12] = 0x11;
+    bus.regs[0x13] = 0x22;
+    bus.regs[0x14] = 0x33;
+    TEST_ASSERT_TRUE(TWIQueue::submit(&tx, 0x20, 0x12, in, 3, true));
+    bus.run();
+    TEST_ASSERT_EQUAL_UINT8(TWI_DONE, tx.status);
+    // Register address written, then read after a repeated start; the last byte is NACKed
+    TEST_ASSERT_EQUAL_STRING("S A20W 12 Sr A20R <11 <22 <33- P", bus.log.c_str());
+    TEST_ASSERT_EQUAL_HEX8(0x11, in[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x22, in[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x33, in[2]);
+}
+
+void test_read_single_byte(void)
+{
+    uint8_t in = 0;
+    TWItx tx;
+    bus.regs[0x05] = 0x5A;
+    TEST_ASSERT_TRUE(TWIQueue::submit(&tx, 0x20, 0x05, &in, 1, true));
+    bus.run();
+    TEST_ASSERT_EQUAL_UINT8(TWI_DONE, tx.status);
+    TEST_ASSERT_EQUAL_STRING("S A20W 05 Sr A20R <5A- P", bus.log.c_str());
+    TEST_ASSERT_EQUAL_HEX8(0x5A, in);
+}
+
+void test_empty_read_rejected(void)
+{
+    uint8_t in = 0;
+    TWItx tx;
+    tx.status = TWI_IDLE;
+    TEST_ASSERT_FALSE(TWIQueue::submit(&tx, 0x20, 0x00, &in, 0, true));
+    TEST_ASSERT_EQUAL_UINT8(TWI_IDLE, tx.status);
+    TEST_ASSERT_TRUE(TWIQueue::idle());
+}
+
+// Transactions queued together are chained (STOP+START) in order of submission
+void test_queue_order(void)
+{
+    uint8_t w1[2] = { 0x01, 0x02 };
+    uint8_t w2[1] = { 0x03 };
+    uint8_t in[2] = { 0 };
+    TWItx t1, t2, t3;
+    TEST_ASSERT_TRUE(TWIQueue::submit(&t1, 0x20, 0x14, w1, 2, false));
+    TEST_ASSERT_TRUE(TWIQueue::submit(&t2, 0x20, 0x14, in, 2, true));
+    TEST_ASSERT_TRUE(TWIQueue::submit(&t3, 0x20, 0x15, w2, 1, false));
+    TEST_ASSERT_EQUAL_UINT8(3, TWIQueue::pending());
+    // Only the first transaction has been started
+    TEST_ASSERT_EQUAL_STRING("S", bus.log.c_str());
+    bus.run();
+    TEST_ASSERT_EQUAL_STRING(
+        "S A20W 14 01 02 P S A20W 14 Sr A20R <01 <02- P S A20W 15 03 P", bus.log.c_str());
+    TEST_ASSERT_EQUAL_UINT8(TWI_DONE, t1.status);
+    TEST_ASSERT_EQUAL_UINT8(TWI_DONE, t2.status);
+    TEST_ASSERT_EQUAL_UINT8(TWI_DONE, t3.status);
+    TEST_ASSERT_EQUAL_HEX8(0x01, in[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, in[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, bus.regs[0x15]);
+    TEST_ASSERT_TRUE(TWIQueue::idle());
+}
+
+void test_queue_full(void)
+{
+    static TWItx tx[TWIQueue::QSIZE + 1];
+    static uint8_t b[TWIQueue::QSIZE + 1];
+    for(uint8_t i = 0; i < TWIQueue::QSIZE; i++) {
+        TEST_ASSERT_TRUE(TWIQueue::submit(&tx[i], 0x20, i, &b[i], 1, false));
+    }
+    TEST_ASSERT_FALSE(TWIQueue::submit(&tx[TWIQueue::QSIZE], 0x20, 0, b, 1, false));
+    bus.run();
+    for(uint8_t i = 0; i < TWIQueue::QSIZE; i++) TEST_ASSERT_EQUAL_UINT8(TWI_DONE, tx[i].status);
+    // Room again, and the indexes have moved past the end of the queue array
+    TEST_ASSERT_TRUE(TWIQueue::submit(&tx[TWIQueue::QSIZE], 0x20, 0, b, 1, false));
+    bus.run();
+    TEST_ASSERT_EQUAL_UINT8(TWI_DONE, tx[TWIQueue::QSIZE].status);
+}
+
+// A NACK fails the transaction, without stalling the ones queued after it
+void test_nack(void)
+{
+    uint8_t out[2] = { 0x10, 0x20 };
+    uint8_t in = 0;
+    TWItx t1, t2, t3;
+    uint16_t err = TWIQueue::getErrors();
+    bus.regs[0x01] = 0x77;
+    TEST_ASSERT_TRUE(TWIQueue::submit(&t1, 0x27, 0x00, out, 2, false));    // No such device
+    TEST_ASSERT_TRUE(TWIQueue::submit(&t2, 0x20, 0x01, &in, 1, true));
+    TEST_ASSERT_TRUE(TWIQueue::submit(&t3, 0x20, 0x00, out, 2, false));
+    bus.nackAt = 2;                                                         // Second data byte of t3
+    bus.run();
+    TEST_ASSERT_EQUAL_STRING(
+        "S A27W- P S A20W 01 Sr A20R <77- P S A20W 00 10 20 P", bus.log.c_str());
+    TEST_ASSERT_EQUAL_UINT8(TWI_ERROR, t1.status);
+    TEST_ASSERT_EQUAL_UINT8(TWI_DONE,  t2.status);
+    TEST_ASSERT_EQUAL_UINT8(TWI_ERROR, t3.status);
+    TEST_ASSERT_EQUAL_HEX8(0x77, in);
+    TEST_ASSERT_EQUAL_UINT16(err + 2, TWIQueue::getErrors());
+    TEST_ASSERT_TRUE(TWIQueue::idle());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_400kHz);
+    RUN_TEST(test_write);
+    RUN_TEST(test_read_repeated_start);
+    RUN_TEST(test_read_single_byte);
+    RUN_TEST(test_empty_read_rejected);
+    RUN_TEST(test_queue_order);
+    RUN_TEST(test_queue_full);
+    RUN_TEST(test_nack);
+    return UNITY_END();
+}